@@ -10,6 +10,15 @@
 #pragma once
 
 #include <LibCompiler/Defines.h>
+#include <LibCompiler/StringTable.h>
+#include <fcntl.h>
+#include <span>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
 
 #define kAEMag0 'A'
 #define kAEMag1 'E'
@@ -19,6 +28,9 @@
 #define kAEMagLen	 (2)
 #define kAENullType	 (0x00)
 
+// older objects have a zero fVersion, their records carry their names inline.
+#define kAEVersion (2)
+
 // Advanced Executable File Format for ld64.
 // Reloctable by offset is the default strategy.
 // You can also relocate at runtime but that's up to the operating system loader.
@@ -37,7 +49,8 @@ namespace LibCompiler
 		CharType fSize;
 		SizeType fStartCode;
 		SizeType fCodeSize;
-		CharType fPad[kAEPad];
+		CharType fVersion;
+		CharType fPad[kAEPad - 1];
 	} PACKED AEHeader, *AEHeaderPtr;
 
 	// @brief Advanced Executable Record.
@@ -54,11 +67,55 @@ namespace LibCompiler
 		CharType fPad[kAEPad];
 	} PACKED AERecordHeader, *AERecordHeaderPtr;
 
+	// @brief Advanced Executable Record, version 2 and later.
+	// fName is an offset into the string table, which follows the records.
+	// The string table starts with an empty name, and ends at fStartCode.
+
+	typedef struct AERecordHeaderV2 final
+	{
+		SizeType fName;
+		SizeType fKind;
+		SizeType fSize;
+		SizeType fFlags;
+		UIntPtr	 fOffset;
+		CharType fPad[kAEPad];
+	} PACKED AERecordHeaderV2, *AERecordHeaderV2Ptr;
+
 	enum
 	{
 		kKindRelocationByOffset	 = 0x23f,
 		kKindRelocationAtRuntime = 0x34f,
 	};
+
+	// @brief Record kind of the relocation section.
+	// Its record has no name, so that older linkers skip it.
+	// fOffset is the file offset of the section, fSize its size.
+	enum
+	{
+		kAERelocationSection = 0x52,
+	};
+
+	// @brief Relocation section header, the entries then the string table follow it.
+	typedef struct AERelocationHeader final
+	{
+		SizeType fCount;	   // number of AERelocation entries.
+		SizeType fStringsSize; // size of the string table, NUL separated symbol names.
+		CharType fPad[kAEPad];
+	} PACKED AERelocationHeader, *AERelocationHeaderPtr;
+
+	// @brief Relocation entry, fixed size.
+	typedef struct AERelocation final
+	{
+		SizeType fOffset; // offset to patch, from the start of the code.
+		UInt32	 fType;	  // kAERelocation* type.
+		UInt32	 fSymbol; // index of the symbol in the string table.
+		Int64	 fAddend; // added to the symbol's address.
+	} PACKED AERelocation, *AERelocationPtr;
+
+	enum
+	{
+		kAERelocationAbs64 = 0x1, // 64-bit absolute address of the symbol.
+	};
 } // namespace LibCompiler
 
 // provide operator<< for AE
@@ -78,6 +135,14 @@ inline std::ofstream& operator<<(std::ofstream&				  fp,
 	return fp;
 }
 
+inline std::ofstream& operator<<(std::ofstream&					fp,
+								 LibCompiler::AERecordHeaderV2& container)
+{
+	fp.write((char*)&container, sizeof(LibCompiler::AERecordHeaderV2));
+
+	return fp;
+}
+
 inline std::ifstream& operator>>(std::ifstream& fp, LibCompiler::AEHeader& container)
 {
 	fp.read((char*)&container, sizeof(LibCompiler::AEHeader));
@@ -91,8 +156,61 @@ inline std::ifstream& operator>>(std::ifstream&				  fp,
 	return fp;
 }
 
+inline std::ifstream& operator>>(std::ifstream&					fp,
+								 LibCompiler::AERecordHeaderV2& container)
+{
+	fp.read((char*)&container, sizeof(LibCompiler::AERecordHeaderV2));
+	return fp;
+}
+
 namespace LibCompiler::Utils
 {
+	/**
+	 * @brief Parse a relocation section, both readers go through it.
+	 *
+	 * @param section the bytes of the record of kind kAERelocationSection.
+	 * @param relocs the relocations, in the object's order, they point into section.
+	 * @param symbols the symbol names, a relocation's fSymbol indexes it.
+	 * @return false if the section is malformed.
+	 */
+	inline bool ae_parse_relocations(std::span<const char> section, std::span<const AERelocation>& relocs,
+									 std::vector<std::string_view>& symbols)
+	{
+		if (section.size() < sizeof(AERelocationHeader))
+			return false;
+
+		auto& hdr = *reinterpret_cast<const AERelocationHeader*>(section.data());
+
+		if (hdr.fCount > section.size() / sizeof(AERelocation) ||
+			sizeof(AERelocationHeader) + hdr.fCount * sizeof(AERelocation) + hdr.fStringsSize != section.size())
+			return false;
+
+		relocs = {reinterpret_cast<const AERelocation*>(section.data() + sizeof(AERelocationHeader)), hdr.fCount};
+
+		std::string_view strings(reinterpret_cast<const char*>(relocs.data() + relocs.size()), hdr.fStringsSize);
+
+		symbols.clear();
+
+		for (SizeType start = 0UL; start < strings.size();)
+		{
+			auto end = strings.find('\0', start);
+
+			if (end == std::string_view::npos)
+				end = strings.size();
+
+			symbols.emplace_back(strings.substr(start, end - start));
+			start = end + 1;
+		}
+
+		for (auto& reloc : relocs)
+		{
+			if (reloc.fSymbol >= symbols.size())
+				return false;
+		}
+
+		return true;
+	}
+
 	/**
 	 * @brief AE Reader protocol
 	 *
@@ -109,20 +227,113 @@ namespace LibCompiler::Utils
 		LIBCOMPILER_COPY_DELETE(AEReadableProtocol);
 
 		/**
-		 * @brief Read AE Record headers.
+		 * @brief Read the header of an object, Read and ReadRecords depend on its version.
+		 *
+		 * @param hdr the header, FP must be at the start of the object.
+		 * @return false if it isn't an AE header.
+		 */
+		bool ReadHeader(AEHeader& hdr)
+		{
+			FP >> hdr;
+
+			fVersion = hdr.fVersion;
+
+			return FP.good() && hdr.fMagic[0] == kAEMag0 && hdr.fMagic[1] == kAEMag1 && hdr.fSize == sizeof(AEHeader);
+		}
+
+		/**
+		 * @brief Read AE Record headers, of an object written before kAEVersion.
 		 *
 		 * @param raw the containing buffer
 		 * @param sz it's size (1 = one AERecordHeader, 2 two AERecordHeader(s))
-		 * @return AERecordHeaderPtr
+		 * @return AERecordHeaderPtr, nullptr if the header read has compact records, see ReadRecords.
 		 */
 		AERecordHeaderPtr Read(char* raw, std::size_t sz)
 		{
-			if (!raw)
+			if (!raw || fVersion >= kAEVersion)
 				return nullptr;
 
 			return this->_Read<AERecordHeader>(raw, sz * sizeof(AERecordHeader));
 		}
 
+		/**
+		 * @brief Read the records of an object, whatever its version is.
+		 *
+		 * @param hdr the header of the object, FP must be right after it.
+		 * @param records the records, with their names inline.
+		 * @return false if the records or their string table are malformed.
+		 */
+		bool ReadRecords(const AEHeader& hdr, std::vector<AERecordHeader>& records)
+		{
+			records.assign(hdr.fCount, AERecordHeader{});
+
+			if (hdr.fVersion < kAEVersion)
+			{
+				this->_Read<AERecordHeader>((char*)records.data(), hdr.fCount * sizeof(AERecordHeader));
+				return FP.good();
+			}
+
+			std::vector<AERecordHeaderV2> compact_records(hdr.fCount);
+			this->_Read<AERecordHeaderV2>((char*)compact_records.data(), hdr.fCount * sizeof(AERecordHeaderV2));
+
+			SizeType strings_start = sizeof(AEHeader) + hdr.fCount * sizeof(AERecordHeaderV2);
+
+			if (!FP.good() || hdr.fStartCode < strings_start)
+				return false;
+
+			std::string strings(hdr.fStartCode - strings_start, 0);
+			FP.read(strings.data(), std::streamsize(strings.size()));
+
+			for (SizeType index = 0; index < hdr.fCount; ++index)
+			{
+				auto& compact = compact_records[index];
+				auto& record  = records[index];
+
+				if (compact.fName >= strings.size())
+					return false;
+
+				// names longer than an inline one are cut, like an old object would have them.
+				strncpy(record.fName, strings.c_str() + compact.fName, kAESymbolLen - 1);
+
+				record.fKind   = compact.fKind;
+				record.fSize   = compact.fSize;
+				record.fFlags  = compact.fFlags;
+				record.fOffset = compact.fOffset;
+			}
+
+			return FP.good();
+		}
+
+		/**
+		 * @brief Read the relocation section of an object.
+		 *
+		 * @param record the record of kind kAERelocationSection.
+		 * @param relocs the relocations, in the object's order.
+		 * @param symbols the symbol names, a relocation's fSymbol indexes it.
+		 * @return false if the section is malformed.
+		 */
+		bool ReadRelocations(const AERecordHeader& record, std::vector<AERelocation>& relocs, std::vector<std::string>& symbols)
+		{
+			if (record.fKind != kAERelocationSection)
+				return false;
+
+			std::vector<char> section(record.fSize);
+
+			FP.seekg(std::streamoff(record.fOffset));
+			this->_Read<char>(section.data(), section.size());
+
+			std::span<const AERelocation> section_relocs;
+			std::vector<std::string_view> section_symbols;
+
+			if (!FP.good() || !ae_parse_relocations(section, section_relocs, section_symbols))
+				return false;
+
+			relocs.assign(section_relocs.begin(), section_relocs.end());
+			symbols.assign(section_symbols.begin(), section_symbols.end());
+
+			return true;
+		}
+
 	private:
 		/**
 		 * @brief Implementation of Read for raw classes.
@@ -138,5 +349,250 @@ namespace LibCompiler::Utils
 			FP.read(raw, std::streamsize(sz));
 			return reinterpret_cast<TypeClass*>(raw);
 		}
+
+	private:
+		CharType fVersion{0}; // of the header ReadHeader read.
+	};
+
+	/**
+	 * @brief A record of a mapped object, its name points into the mapping.
+	 */
+	struct AEMappedRecord final
+	{
+		std::string_view fName;
+		SizeType		 fKind{0UL};
+		SizeType		 fSize{0UL};
+		SizeType		 fFlags{0UL};
+		UIntPtr			 fOffset{0UL};
+	};
+
+	/**
+	 * @brief A memory mapped AE object, of any version.
+	 * The header is validated once, then records, names and code are views into the mapping.
+	 * The mapping is private, patching the code (relocations) never reaches the file.
+	 */
+	class AEMappedObject final
+	{
+	public:
+		AEMappedObject() = default;
+
+		explicit AEMappedObject(const std::string& path)
+			: AEMappedObject(path, 0UL, 0UL)
+		{
+		}
+
+		/// @brief Map an object stored in a bigger file, such as a member of a static library.
+		/// @param size its size, zero maps up to the end of the file.
+		AEMappedObject(const std::string& path, SizeType offset, SizeType size)
+		{
+			int fd = ::open(path.c_str(), O_RDONLY);
+
+			if (fd < 0)
+				return;
+
+			struct stat st;
+
+			if (::fstat(fd, &st) == 0 && offset <= SizeType(st.st_size))
+			{
+				if (size == 0UL)
+					size = st.st_size - offset;
+
+				// a mapping starts on a page boundary.
+				SizeType skip = offset % ::sysconf(_SC_PAGESIZE);
+
+				if (size >= sizeof(AEHeader) && size <= st.st_size - offset)
+				{
+					void* data = ::mmap(nullptr, size + skip, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, offset - skip);
+
+					if (data != MAP_FAILED)
+					{
+						fMapping	 = data;
+						fMappingSize = size + skip;
+						fData		 = static_cast<char*>(data) + skip;
+						fSize		 = size;
+					}
+				}
+			}
+
+			// the mapping stays valid once the file is closed.
+			::close(fd);
+
+			fValid = fData && this->Validate();
+		}
+
+		~AEMappedObject()
+		{
+			if (fMapping)
+				::munmap(fMapping, fMappingSize);
+		}
+
+		AEMappedObject(AEMappedObject&& other) noexcept
+		{
+			*this = std::move(other);
+		}
+
+		AEMappedObject& operator=(AEMappedObject&& other) noexcept
+		{
+			std::swap(fMapping, other.fMapping);
+			std::swap(fMappingSize, other.fMappingSize);
+			std::swap(fData, other.fData);
+			std::swap(fSize, other.fSize);
+			std::swap(fStrings, other.fStrings);
+			std::swap(fValid, other.fValid);
+
+			return *this;
+		}
+
+		LIBCOMPILER_COPY_DELETE(AEMappedObject);
+
+	public:
+		/// @brief Is it a well formed AE object?
+		bool IsValid() const noexcept
+		{
+			return fValid;
+		}
+
+		const AEHeader& Header() const noexcept
+		{
+			return *reinterpret_cast<const AEHeader*>(fData);
+		}
+
+		SizeType Count() const noexcept
+		{
+			return this->Header().fCount;
+		}
+
+		/// @brief Fetch a record, whatever the version of the object is.
+		AEMappedRecord Record(SizeType index) const noexcept
+		{
+			AEMappedRecord record{};
+
+			if (this->Header().fVersion < kAEVersion)
+			{
+				auto& inline_record = this->InlineRecords()[index];
+
+				record.fName   = std::string_view(inline_record.fName, strnlen(inline_record.fName, kAESymbolLen));
+				record.fKind   = inline_record.fKind;
+				record.fSize   = inline_record.fSize;
+				record.fFlags  = inline_record.fFlags;
+				record.fOffset = inline_record.fOffset;
+
+				return record;
+			}
+
+			auto& compact = this->CompactRecords()[index];
+
+			record.fName   = std::string_view(fStrings.data() + compact.fName);
+			record.fKind   = compact.fKind;
+			record.fSize   = compact.fSize;
+			record.fFlags  = compact.fFlags;
+			record.fOffset = compact.fOffset;
+
+			return record;
+		}
+
+		/// @brief The records of an object written before kAEVersion, empty otherwise.
+		std::span<const AERecordHeader> InlineRecords() const noexcept
+		{
+			if (this->Header().fVersion >= kAEVersion)
+				return {};
+
+			return {reinterpret_cast<const AERecordHeader*>(fData + sizeof(AEHeader)), this->Count()};
+		}
+
+		/// @brief The records of an object of kAEVersion or later, empty otherwise.
+		std::span<const AERecordHeaderV2> CompactRecords() const noexcept
+		{
+			if (this->Header().fVersion < kAEVersion)
+				return {};
+
+			return {reinterpret_cast<const AERecordHeaderV2*>(fData + sizeof(AEHeader)), this->Count()};
+		}
+
+		/// @brief The string table, empty for an object written before kAEVersion.
+		std::string_view Strings() const noexcept
+		{
+			return fStrings;
+		}
+
+		/// @brief The whole object, as it is on disk.
+		std::span<const char> Bytes() const noexcept
+		{
+			return {fData, fSize};
+		}
+
+		/// @brief The code of the object, it may be patched in place.
+		std::span<char> Code() noexcept
+		{
+			return {fData + this->Header().fStartCode, this->Header().fCodeSize};
+		}
+
+		std::span<const char> Code() const noexcept
+		{
+			return {fData + this->Header().fStartCode, this->Header().fCodeSize};
+		}
+
+		/**
+		 * @brief Fetch the relocation section of the object.
+		 *
+		 * @param record the record of kind kAERelocationSection.
+		 * @param relocs the relocations, in the object's order.
+		 * @param symbols the symbol names, a relocation's fSymbol indexes it.
+		 * @return false if the section is malformed.
+		 */
+		bool Relocations(const AEMappedRecord& record, std::span<const AERelocation>& relocs,
+						 std::vector<std::string_view>& symbols) const
+		{
+			if (record.fKind != kAERelocationSection || record.fOffset > fSize || record.fSize > fSize - record.fOffset)
+				return false;
+
+			return ae_parse_relocations({fData + record.fOffset, record.fSize}, relocs, symbols);
+		}
+
+	private:
+		bool Validate() noexcept
+		{
+			auto& hdr = this->Header();
+
+			if (hdr.fMagic[0] != kAEMag0 || hdr.fMagic[1] != kAEMag1 ||
+				hdr.fSize != sizeof(AEHeader))
+				return false;
+
+			if (hdr.fStartCode < sizeof(AEHeader) || hdr.fStartCode > fSize ||
+				hdr.fCodeSize > fSize - hdr.fStartCode)
+				return false;
+
+			SizeType record_size = hdr.fVersion < kAEVersion ? sizeof(AERecordHeader) : sizeof(AERecordHeaderV2);
+
+			if (hdr.fCount > (hdr.fStartCode - sizeof(AEHeader)) / record_size)
+				return false;
+
+			if (hdr.fVersion < kAEVersion)
+				return true;
+
+			SizeType strings_start = sizeof(AEHeader) + hdr.fCount * record_size;
+
+			// names are read until their NUL, so the table must end with one.
+			if (hdr.fStartCode == strings_start || fData[hdr.fStartCode - 1] != 0)
+				return false;
+
+			fStrings = std::string_view(fData + strings_start, hdr.fStartCode - strings_start);
+
+			for (auto& compact : this->CompactRecords())
+			{
+				if (compact.fName >= fStrings.size())
+					return false;
+			}
+
+			return true;
+		}
+
+	private:
+		void*			 fMapping{nullptr};
+		SizeType		 fMappingSize{0UL};
+		char*			 fData{nullptr};
+		SizeType		 fSize{0UL};
+		std::string_view fStrings;
+		bool			 fValid{false};
 	};
 } // namespace LibCompiler::Utils
@@ -0,0 +1,164 @@
+/*
+ * ========================================================
+ *
+ *      LibCompiler
+ *      Copyright (C) 2024-2025 Amlal El Mahrouss, all rights reserved.
+ *
+ * ========================================================
+ */
+
+#pragma once
+
+#include <LibCompiler/Defines.h>
+#include <LibCompiler/StringTable.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define kARMagic	"Lib!"
+#define kARMagLen	(4)
+#define kARVersion	(1)
+#define kARAlign	(8)
+#define kARPad		(8)
+#define kARNoMember (~0UL)
+
+// Static library (kPefLibExt) for ld64.
+// AE objects bundled with an index of the symbols they define, so that the linker
+// reads the index, then only the members it needs.
+
+namespace LibCompiler
+{
+	// @brief Static library header.
+	// The member table, the symbol index and the string table follow it, then the members.
+	typedef struct ARHeader final
+	{
+		CharType fMagic[kARMagLen];
+		UInt32	 fVersion;
+		SizeType fMemberCount;
+		SizeType fSymbolCount;
+		SizeType fStringsSize;
+		SizeType fIndexSize; // the header and its tables, the first member starts after it.
+		CharType fPad[kARPad];
+	} PACKED ARHeader, *ARHeaderPtr;
+
+	// @brief A member of the library, an AE object as it is on disk.
+	typedef struct ARMember final
+	{
+		SizeType fName;	  // its file name, offset in the string table.
+		SizeType fOffset; // file offset of the object, kARAlign aligned.
+		SizeType fSize;
+		UInt32	 fArch;
+		UInt32	 fFlags;
+	} PACKED ARMember, *ARMemberPtr;
+
+	// @brief An entry of the symbol index, entries are sorted by name.
+	// A name is indexed once per architecture, a library may hold members for several.
+	typedef struct ARSymbol final
+	{
+		SizeType fName; // demangled name, offset in the string table.
+		SizeType fMember;
+	} PACKED ARSymbol, *ARSymbolPtr;
+} // namespace LibCompiler
+
+namespace LibCompiler::Utils
+{
+	/// @brief The index of a static library, the members stay on disk.
+	class ARIndex final
+	{
+	public:
+		ARIndex()  = default;
+		~ARIndex() = default;
+
+		LIBCOMPILER_COPY_DEFAULT(ARIndex);
+
+	public:
+		/// @brief Read the index of a library.
+		/// @return false if it isn't a well formed library.
+		bool Read(const std::string& path)
+		{
+			std::ifstream input(path, std::ifstream::binary);
+
+			if (!input.read(reinterpret_cast<char*>(&fHeader), sizeof(ARHeader)) ||
+				memcmp(fHeader.fMagic, kARMagic, kARMagLen) != 0 || fHeader.fVersion != kARVersion)
+				return false;
+
+			input.seekg(0, std::ifstream::end);
+
+			SizeType size = input.tellg();
+
+			if (fHeader.fIndexSize > size || fHeader.fMemberCount > size / sizeof(ARMember) ||
+				fHeader.fSymbolCount > size / sizeof(ARSymbol) || fHeader.fStringsSize > size ||
+				sizeof(ARHeader) + fHeader.fMemberCount * sizeof(ARMember) + fHeader.fSymbolCount * sizeof(ARSymbol) +
+						fHeader.fStringsSize !=
+					fHeader.fIndexSize ||
+				fHeader.fStringsSize == 0UL)
+				return false;
+
+			fMembers.resize(fHeader.fMemberCount);
+			fSymbols.resize(fHeader.fSymbolCount);
+			fStrings.resize(fHeader.fStringsSize);
+
+			input.seekg(sizeof(ARHeader));
+
+			if (!input.read(reinterpret_cast<char*>(fMembers.data()), fMembers.size() * sizeof(ARMember)) ||
+				!input.read(reinterpret_cast<char*>(fSymbols.data()), fSymbols.size() * sizeof(ARSymbol)) ||
+				!input.read(fStrings.data(), fStrings.size()) || fStrings.back() != 0)
+				return false;
+
+			for (auto& member : fMembers)
+			{
+				if (member.fName >= fStrings.size() || member.fOffset > size || member.fSize > size - member.fOffset)
+					return false;
+			}
+
+			for (auto& symbol : fSymbols)
+			{
+				if (symbol.fName >= fStrings.size() || symbol.fMember >= fMembers.size())
+					return false;
+			}
+
+			return true;
+		}
+
+		/// @brief The member defining a symbol for arch, or kARNoMember.
+		SizeType Find(std::string_view name, UInt32 arch) const noexcept
+		{
+			auto it = std::lower_bound(fSymbols.begin(), fSymbols.end(), name, [this](const ARSymbol& symbol, std::string_view name) {
+				return this->Name(symbol.fName) < name;
+			});
+
+			for (; it != fSymbols.end() && this->Name(it->fName) == name; ++it)
+			{
+				if (fMembers[it->fMember].fArch == arch)
+					return it->fMember;
+			}
+
+			return kARNoMember;
+		}
+
+		/// @brief A name of the string table.
+		std::string_view Name(SizeType offset) const noexcept
+		{
+			return fStrings.c_str() + offset;
+		}
+
+		const std::vector<ARMember>& Members() const noexcept
+		{
+			return fMembers;
+		}
+
+		const std::vector<ARSymbol>& Symbols() const noexcept
+		{
+			return fSymbols;
+		}
+
+	private:
+		ARHeader			  fHeader{};
+		std::vector<ARMember> fMembers;
+		std::vector<ARSymbol> fSymbols;
+		std::string			  fStrings;
+	};
+} // namespace LibCompiler::Utils
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <LibCompiler/Defines.h>
+#include <string_view>
 #include <vector>
 
 // @brief 64x0 support.
@@ -61,6 +62,20 @@ inline std::vector<CpuOpcode64x0> kOpcodes64x0 = {
 		kAsmOpcodeDecl("subc", 0b0101011, 0b111, kAsmImmediate)
 			kAsmOpcodeDecl("sc", 0b1110011, 0b00, kAsmSyscall)};
 
+/// @brief Find a 64x0 opcode by its mnemonic.
+/// @param name the mnemonic, e.g lda, sta...
+/// @return the opcode, or nullptr if it isn't an instruction.
+inline const CpuOpcode64x0* find_opcode_64x0(std::string_view name) noexcept
+{
+	for (auto& opcode : kOpcodes64x0)
+	{
+		if (name == opcode.fName)
+			return &opcode;
+	}
+
+	return nullptr;
+}
+
 // \brief 64x0 register prefix
 // example: r32, r0
 // r32 -> sp
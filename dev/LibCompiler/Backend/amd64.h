@@ -7,6 +7,9 @@
 #pragma once
 
 #include <LibCompiler/Defines.h>
+#include <algorithm>
+#include <array>
+#include <string_view>
 
 // @brief AMD64 support.
 // @file Backend/amd64.hpp
@@ -22,12 +25,12 @@ typedef uint32_t i64_word_t;
 
 struct CpuOpcodeAMD64
 {
-	std::string fName;
-	i64_byte_t	fPrefixBytes[4];
-	i64_hword_t fOpcode;
-	i64_hword_t fModReg;
-	i64_word_t	fDisplacment;
-	i64_word_t	fImmediate;
+	std::string_view fName;
+	i64_byte_t		 fPrefixBytes[4];
+	i64_hword_t		 fOpcode;
+	i64_hword_t		 fModReg;
+	i64_word_t		 fDisplacment;
+	i64_word_t		 fImmediate;
 };
 
 /// these two are edge cases
@@ -39,20 +42,79 @@ struct CpuOpcodeAMD64
 #define kJumpLimitStandard		0xE3
 #define kJumpLimitStandardLimit 0xEB
 
-inline std::vector<CpuOpcodeAMD64> kOpcodesAMD64 = {
+/// @brief AMD64 opcode table, sorted by mnemonic so it can be binary searched.
+/// @note Keep this table sorted! the static_assert below checks it at compile time.
+inline constexpr auto kOpcodesAMD64 = std::to_array<CpuOpcodeAMD64>({
+	kAsmOpcodeDecl("call", 0xFF)
+	kAsmOpcodeDecl("cli", 0xfa)
+	kAsmOpcodeDecl("hlt", 0xf4)
 	kAsmOpcodeDecl("int", 0xCD)
-		kAsmOpcodeDecl("into", 0xCE)
-			kAsmOpcodeDecl("intd", 0xF1)
-				kAsmOpcodeDecl("int3", 0xC3)
-					kAsmOpcodeDecl("iret", 0xCF)
-						kAsmOpcodeDecl("retf", 0xCB)
-							kAsmOpcodeDecl("retn", 0xC3)
-								kAsmOpcodeDecl("ret", 0xC3)
-									kAsmOpcodeDecl("sti", 0xfb)
-										kAsmOpcodeDecl("cli", 0xfa)
-											kAsmOpcodeDecl("hlt", 0xf4)
-												kAsmOpcodeDecl("nop", 0x90)
-													kAsmOpcodeDecl("mov", 0x48)
-														kAsmOpcodeDecl("call", 0xFF)};
+	kAsmOpcodeDecl("int3", 0xC3)
+	kAsmOpcodeDecl("intd", 0xF1)
+	kAsmOpcodeDecl("into", 0xCE)
+	kAsmOpcodeDecl("iret", 0xCF)
+	kAsmOpcodeDecl("ja", kAsmJumpOpcode + 0)
+	kAsmOpcodeDecl("jae", kAsmJumpOpcode + 1)
+	kAsmOpcodeDecl("jb", kAsmJumpOpcode + 2)
+	kAsmOpcodeDecl("jbe", kAsmJumpOpcode + 3)
+	kAsmOpcodeDecl("jc", kAsmJumpOpcode + 4)
+	kAsmOpcodeDecl("jcxz", kJumpLimitStandard)
+	kAsmOpcodeDecl("je", kAsmJumpOpcode + 5)
+	kAsmOpcodeDecl("jg", kAsmJumpOpcode + 6)
+	kAsmOpcodeDecl("jge", kAsmJumpOpcode + 7)
+	kAsmOpcodeDecl("jl", kAsmJumpOpcode + 8)
+	kAsmOpcodeDecl("jle", kAsmJumpOpcode + 9)
+	kAsmOpcodeDecl("jmp", kJumpLimitStandard)
+	kAsmOpcodeDecl("jna", kAsmJumpOpcode + 10)
+	kAsmOpcodeDecl("jnae", kAsmJumpOpcode + 11)
+	kAsmOpcodeDecl("jnb", kAsmJumpOpcode + 12)
+	kAsmOpcodeDecl("jnbe", kAsmJumpOpcode + 13)
+	kAsmOpcodeDecl("jnc", kAsmJumpOpcode + 14)
+	kAsmOpcodeDecl("jne", kAsmJumpOpcode + 15)
+	kAsmOpcodeDecl("jng", kAsmJumpOpcode + 16)
+	kAsmOpcodeDecl("jnge", kAsmJumpOpcode + 17)
+	kAsmOpcodeDecl("jnl", kAsmJumpOpcode + 18)
+	kAsmOpcodeDecl("jnle", kAsmJumpOpcode + 19)
+	kAsmOpcodeDecl("jno", kAsmJumpOpcode + 20)
+	kAsmOpcodeDecl("jnp", kAsmJumpOpcode + 21)
+	kAsmOpcodeDecl("jns", kAsmJumpOpcode + 22)
+	kAsmOpcodeDecl("jnz", kAsmJumpOpcode + 23)
+	kAsmOpcodeDecl("jo", kAsmJumpOpcode + 24)
+	kAsmOpcodeDecl("jp", kAsmJumpOpcode + 25)
+	kAsmOpcodeDecl("jpe", kAsmJumpOpcode + 26)
+	kAsmOpcodeDecl("jpo", kAsmJumpOpcode + 27)
+	kAsmOpcodeDecl("js", kAsmJumpOpcode + 28)
+	kAsmOpcodeDecl("jz", kAsmJumpOpcode + 29)
+	kAsmOpcodeDecl("lahf", 0x9F)
+	kAsmOpcodeDecl("lds", 0xC5)
+	kAsmOpcodeDecl("lea", 0x8D)
+	kAsmOpcodeDecl("mov", 0x48)
+	kAsmOpcodeDecl("nop", 0x90)
+	kAsmOpcodeDecl("ret", 0xC3)
+	kAsmOpcodeDecl("retf", 0xCB)
+	kAsmOpcodeDecl("retn", 0xC3)
+	kAsmOpcodeDecl("sti", 0xfb)});
+
+static_assert(std::is_sorted(kOpcodesAMD64.begin(), kOpcodesAMD64.end(),
+							 [](const CpuOpcodeAMD64& lhs, const CpuOpcodeAMD64& rhs) {
+								 return lhs.fName < rhs.fName;
+							 }),
+			  "kOpcodesAMD64 must be sorted by mnemonic.");
+
+/// @brief Find an AMD64 opcode by its mnemonic.
+/// @param name the mnemonic, e.g mov, jmp...
+/// @return the opcode, or nullptr if it isn't an instruction.
+inline constexpr const CpuOpcodeAMD64* find_opcode_amd64(std::string_view name) noexcept
+{
+	auto it = std::lower_bound(kOpcodesAMD64.begin(), kOpcodesAMD64.end(), name,
+							   [](const CpuOpcodeAMD64& opcode, std::string_view key) {
+								   return opcode.fName < key;
+							   });
+
+	if (it == kOpcodesAMD64.end() || it->fName != name)
+		return nullptr;
+
+	return &*it;
+}
 
 #define kAsmRegisterLimit 16
@@ -11,6 +11,8 @@
 #pragma once
 
 #include <stdint.h>
+#include <string_view>
+#include <unordered_map>
 
 /// @note Based of:
 /// https://opensource.apple.com/source/cctools/cctools-750/as/ppc-opcode.h.auto.html
@@ -1916,6 +1918,30 @@ inline CpuOpcodePPC kOpcodesPowerPC[] = {
 	{0, ""} /* end of table marker */
 };
 
+/// @brief Find a POWER opcode by its mnemonic.
+/// @note The index is built once, the first entry of a mnemonic wins like the table scan did.
+/// @param name the mnemonic, e.g li, stw...
+/// @return the opcode, or nullptr if it isn't an instruction.
+inline const CpuOpcodePPC* find_opcode_power64(std::string_view name)
+{
+	static const auto kIndex = [] {
+		std::unordered_map<std::string_view, const CpuOpcodePPC*> index;
+
+		for (auto& opcode : kOpcodesPowerPC)
+		{
+			if (*opcode.name)
+				index.emplace(opcode.name, &opcode);
+		}
+
+		return index;
+	}();
+
+	if (auto it = kIndex.find(name); it != kIndex.end())
+		return it->second;
+
+	return nullptr;
+}
+
 #define kAsmFloatZeroRegister 0
 #define kAsmZeroRegister	  0
 
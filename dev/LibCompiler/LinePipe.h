@@ -0,0 +1,216 @@
+/*
+ *	========================================================
+ *
+ *	LibCompiler
+ * 	Copyright (C) 2024-2025 Amlal El Mahrouss, all rights reserved.
+ *
+ * 	========================================================
+ */
+
+#pragma once
+
+#include <LibCompiler/Defines.h>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <string>
+
+#define kLinePipeCapacity (4096)
+
+// Lines streamed from a stage of the toolchain to the next one, each stage on its own thread.
+// bpp -> C++ compiler -> assembler, nothing goes through the disk unless it is asked for.
+
+namespace LibCompiler
+{
+	/// @brief A bounded queue of lines, the producer waits while it is full.
+	class LinePipe final
+	{
+	public:
+		explicit LinePipe(SizeType capacity = kLinePipeCapacity)
+			: fCapacity(capacity)
+		{
+		}
+
+		~LinePipe() = default;
+
+		LIBCOMPILER_COPY_DELETE(LinePipe);
+
+	public:
+		/// @brief Also write every line to path, as the stage would have.
+		bool Save(const std::string& path)
+		{
+			fSaved = std::make_unique<std::ofstream>(path, std::ofstream::trunc);
+			return fSaved->good();
+		}
+
+		/// @brief Queue a line, without its new line.
+		/// @return false once the pipe is closed, the line is dropped.
+		bool Push(std::string line)
+		{
+			std::unique_lock lock(fLock);
+
+			fNotFull.wait(lock, [this]() { return fClosed || fLines.size() < fCapacity; });
+
+			if (fClosed)
+				return false;
+
+			if (fSaved)
+				(*fSaved) << line << "\n";
+
+			fLines.push_back(std::move(line));
+			fNotEmpty.notify_one();
+
+			return true;
+		}
+
+		/// @brief Take the next line.
+		/// @return false once the pipe is closed and drained.
+		bool Pop(std::string& line)
+		{
+			std::unique_lock lock(fLock);
+
+			fNotEmpty.wait(lock, [this]() { return fClosed || !fLines.empty(); });
+
+			if (fLines.empty())
+				return false;
+
+			line = std::move(fLines.front());
+			fLines.pop_front();
+
+			fNotFull.notify_one();
+
+			return true;
+		}
+
+		/// @brief No more lines, either side may close it.
+		void Close()
+		{
+			std::lock_guard lock(fLock);
+
+			fClosed = true;
+
+			if (fSaved)
+				fSaved->flush();
+
+			fNotEmpty.notify_all();
+			fNotFull.notify_all();
+		}
+
+	private:
+		std::mutex					   fLock;
+		std::condition_variable		   fNotEmpty;
+		std::condition_variable		   fNotFull;
+		std::deque<std::string>		   fLines;
+		SizeType					   fCapacity;
+		Bool						   fClosed{false};
+		std::unique_ptr<std::ofstream> fSaved;
+	};
+
+	/// @brief Writes to a pipe as a stream, a line is pushed once its new line is written.
+	class LinePipeWriter final : public std::streambuf
+	{
+	public:
+		explicit LinePipeWriter(LinePipe& pipe)
+			: fPipe(pipe)
+		{
+		}
+
+		~LinePipeWriter() override = default;
+
+		LIBCOMPILER_COPY_DELETE(LinePipeWriter);
+
+		/// @brief Push what is left of the last line.
+		void Flush()
+		{
+			if (!fLine.empty())
+				fPipe.Push(std::move(fLine));
+
+			fLine.clear();
+		}
+
+	protected:
+		int_type overflow(int_type ch) override
+		{
+			if (traits_type::eq_int_type(ch, traits_type::eof()))
+				return traits_type::not_eof(ch);
+
+			if (ch == '\n')
+			{
+				fPipe.Push(std::move(fLine));
+				fLine.clear();
+			}
+			else
+			{
+				fLine.push_back(traits_type::to_char_type(ch));
+			}
+
+			return ch;
+		}
+
+		std::streamsize xsputn(const char* str, std::streamsize count) override
+		{
+			for (std::streamsize index = 0; index < count;)
+			{
+				auto end = static_cast<const char*>(memchr(str + index, '\n', count - index));
+
+				if (!end)
+				{
+					fLine.append(str + index, count - index);
+					break;
+				}
+
+				fLine.append(str + index, end - (str + index));
+				fPipe.Push(std::move(fLine));
+				fLine.clear();
+
+				index = end - str + 1;
+			}
+
+			return count;
+		}
+
+	private:
+		LinePipe&	fPipe;
+		std::string fLine;
+	};
+
+	/// @brief Reads a pipe as a stream, every line ends with a new line.
+	class LinePipeReader final : public std::streambuf
+	{
+	public:
+		explicit LinePipeReader(LinePipe& pipe)
+			: fPipe(pipe)
+		{
+		}
+
+		~LinePipeReader() override = default;
+
+		LIBCOMPILER_COPY_DELETE(LinePipeReader);
+
+	protected:
+		int_type underflow() override
+		{
+			if (!fPipe.Pop(fLine))
+				return traits_type::eof();
+
+			fLine.push_back('\n');
+			this->setg(fLine.data(), fLine.data(), fLine.data() + fLine.size());
+
+			return traits_type::to_int_type(fLine.front());
+		}
+
+	private:
+		LinePipe&	fPipe;
+		std::string fLine;
+	};
+} // namespace LibCompiler
+
+/// @brief The stages of the in memory pipeline, see cxxdrv -pipe.
+/// each one closes out when it is done, and returns 1 on failure.
+LC_IMPORT_C int CPlusPlusPreprocessorPipe(const char* file, LibCompiler::LinePipe* out);
+LC_IMPORT_C int CompilerCPlusPlusAMD64Pipe(const char* file, LibCompiler::LinePipe* in, LibCompiler::LinePipe* out);
+LC_IMPORT_C int AssemblerAMD64Pipe(const char* file, LibCompiler::LinePipe* in);
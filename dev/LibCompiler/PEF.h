@@ -7,6 +7,7 @@
 #pragma once
 
 #include <LibCompiler/Defines.h>
+#include <LibCompiler/StringTable.h>
 
 // @file PEF.hpp
 // @brief Preferred Executable Format
@@ -31,11 +32,15 @@
 
 #define kPefMagicLen (5)
 
-#define kPefVersion (3)
+#define kPefVersion			   (4)
+#define kPefVersionInlineNames (3) /* last version with names inline in command headers */
 #define kPefNameLen (255)
 
 #define kPefBaseOrigin (0x40000000)
 
+#define kPefFatVersion (1)
+#define kPefFatAlign   (0x1000) /* slices start on a page, a loader maps its own only */
+
 #define kPefStart "__ImageStart"
 
 namespace LibCompiler
@@ -88,6 +93,24 @@ namespace LibCompiler
 		SizeType Count;	 /* container header count */
 	} PACKED PEFContainer, *PEFContainerPtr;
 
+	/* FAT PEF container (kPefMagicFat), the slice table follows it. */
+	/* Every slice is a whole PEF container, its offsets start from the slice. */
+	typedef struct PEFFatContainer final
+	{
+		CharType Magic[kPefMagicLen];
+		UInt32	 Version;
+		UInt32	 Kind;
+		SizeType Count; /* slice count */
+	} PACKED PEFFatContainer, *PEFFatContainerPtr;
+
+	typedef struct PEFFatSlice final
+	{
+		UInt32	 Cpu;
+		UInt32	 SubCpu;
+		UIntPtr	 Offset; /* file offset, kPefFatAlign aligned */
+		SizeType Size;
+	} PACKED PEFFatSlice, *PEFFatSlicePtr;
+
 	/* First PEFCommandHeader starts after PEFContainer */
 	/* Last container is __exec_end */
 
@@ -104,6 +127,20 @@ namespace LibCompiler
 		SizeType Size;				/* file size */
 	} PACKED PEFCommandHeader, *PEFCommandHeaderPtr;
 
+	/* PEF command header, version 4 and later. */
+	/* The string table follows the last command header, it starts with its size. */
+
+	typedef struct PEFCommandHeaderV4 final
+	{
+		SizeType Name;	 /* offset of the container name in the string table */
+		UInt32	 Cpu;	 /* container cpu */
+		UInt32	 SubCpu; /* container sub-cpu */
+		UInt32	 Flags;	 /* container flags */
+		UInt16	 Kind;	 /* container kind */
+		UIntPtr	 Offset; /* file offset */
+		SizeType Size;	 /* file size */
+	} PACKED PEFCommandHeaderV4, *PEFCommandHeaderV4Ptr;
+
 	enum
 	{
 		kPefCode	 = 0xC,
@@ -129,6 +166,13 @@ inline std::ofstream& operator<<(std::ofstream&					fp,
 	return fp;
 }
 
+inline std::ofstream& operator<<(std::ofstream&					  fp,
+								 LibCompiler::PEFCommandHeaderV4& container)
+{
+	fp.write((char*)&container, sizeof(LibCompiler::PEFCommandHeaderV4));
+	return fp;
+}
+
 inline std::ifstream& operator>>(std::ifstream&				fp,
 								 LibCompiler::PEFContainer& container)
 {
@@ -142,3 +186,88 @@ inline std::ifstream& operator>>(std::ifstream&					fp,
 	fp.read((char*)&container, sizeof(LibCompiler::PEFCommandHeader));
 	return fp;
 }
+
+inline std::ifstream& operator>>(std::ifstream&					  fp,
+								 LibCompiler::PEFCommandHeaderV4& container)
+{
+	fp.read((char*)&container, sizeof(LibCompiler::PEFCommandHeaderV4));
+	return fp;
+}
+
+namespace LibCompiler::Utils
+{
+	/* Read the command headers of a container, whatever its version is. */
+	/* fp must be right after the container, the names are put inline. */
+	/* Returns false if the headers or their string table are malformed. */
+	inline bool pef_read_command_headers(std::ifstream& fp, const PEFContainer& container,
+										 std::vector<PEFCommandHeader>& headers)
+	{
+		headers.assign(container.Count, PEFCommandHeader{});
+
+		if (container.Version <= kPefVersionInlineNames)
+		{
+			for (auto& header : headers)
+				fp >> header;
+
+			return fp.good();
+		}
+
+		std::vector<PEFCommandHeaderV4> compact_headers(container.Count);
+
+		for (auto& compact : compact_headers)
+			fp >> compact;
+
+		SizeType strings_size = 0UL;
+		fp.read((char*)&strings_size, sizeof(SizeType));
+
+		if (!fp.good())
+			return false;
+
+		String strings(strings_size, 0);
+		fp.read(strings.data(), std::streamsize(strings_size));
+
+		for (SizeType index = 0; index < container.Count; ++index)
+		{
+			auto& compact = compact_headers[index];
+			auto& header  = headers[index];
+
+			if (compact.Name >= strings.size())
+				return false;
+
+			// names longer than an inline one are cut, like an old container would have them.
+			strncpy(header.Name, strings.c_str() + compact.Name, kPefNameLen - 1);
+
+			header.Cpu	  = compact.Cpu;
+			header.SubCpu = compact.SubCpu;
+			header.Flags  = compact.Flags;
+			header.Kind	  = compact.Kind;
+			header.Offset = compact.Offset;
+			header.Size	  = compact.Size;
+		}
+
+		return fp.good();
+	}
+
+	/* Find the slice of a FAT container for a cpu, only the slice table is read. */
+	/* fp must be at the start of the container, returns false if it has no such slice. */
+	inline bool pef_find_fat_slice(std::ifstream& fp, UInt32 cpu, PEFFatSlice& slice)
+	{
+		PEFFatContainer container{};
+		fp.read((char*)&container, sizeof(PEFFatContainer));
+
+		if (!fp.good() || memcmp(container.Magic, kPefMagicFat, kPefMagicLen - 1) != 0 ||
+			container.Version != kPefFatVersion)
+			return false;
+
+		for (SizeType index = 0; index < container.Count; ++index)
+		{
+			if (!fp.read((char*)&slice, sizeof(PEFFatSlice)))
+				return false;
+
+			if (slice.Cpu == cpu)
+				return true;
+		}
+
+		return false;
+	}
+} // namespace LibCompiler::Utils
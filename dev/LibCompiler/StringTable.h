@@ -0,0 +1,74 @@
+/*
+ *	========================================================
+ *
+ *	LibCompiler
+ * 	Copyright (C) 2024-2025 Amlal El Mahrouss, all rights reserved.
+ *
+ * 	========================================================
+ */
+
+#pragma once
+
+#include <LibCompiler/Defines.h>
+#include <string_view>
+#include <unordered_map>
+
+namespace LibCompiler
+{
+	// @brief Deduplicated string table of an AE object or a PEF container.
+	// Names are NUL terminated and referenced by offset, offset zero is the empty name.
+	class StringTable final
+	{
+	public:
+		explicit StringTable()
+		{
+			this->Clear();
+		}
+
+		~StringTable() = default;
+
+		LIBCOMPILER_COPY_DEFAULT(StringTable);
+		LIBCOMPILER_MOVE_DEFAULT(StringTable);
+
+	public:
+		/// @brief Add a name to the table, once.
+		/// @return its offset in the table.
+		SizeType Intern(std::string_view name)
+		{
+			if (name.empty())
+				return 0UL;
+
+			if (auto it = fOffsets.find(String(name)); it != fOffsets.end())
+				return it->second;
+
+			SizeType offset = fData.size();
+
+			fData += name;
+			fData += '\0';
+
+			fOffsets.emplace(String(name), offset);
+
+			return offset;
+		}
+
+		void Clear()
+		{
+			fOffsets.clear();
+			fData.assign(1, '\0');
+		}
+
+		SizeType Size() const noexcept
+		{
+			return fData.size();
+		}
+
+		const String& Data() const noexcept
+		{
+			return fData;
+		}
+
+	private:
+		std::unordered_map<String, SizeType> fOffsets;
+		String								 fData;
+	};
+} // namespace LibCompiler
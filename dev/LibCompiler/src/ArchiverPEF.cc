@@ -0,0 +1,269 @@
+/* -------------------------------------------
+
+	Copyright (C) 2024-2025 Amlal El Mahrouss, all rights reserved
+
+	@file ArchiverPEF.cc
+	@brief: Static library archiver for ld64.
+
+------------------------------------------- */
+
+/// @brief Bundles AE objects in a static library (kPefLibExt), along with an index of the symbols
+/// they define, ld64 reads the index and pulls only the members it needs.
+
+//! Toolchain Kit.
+#include <LibCompiler/Defines.h>
+#include <LibCompiler/ErrorID.h>
+
+//! Preferred Executable Format
+#include <LibCompiler/PEF.h>
+
+//! Release macros.
+#include <LibCompiler/Version.h>
+
+//! Advanced Executable Object Format.
+#include <LibCompiler/AE.h>
+
+//! Static libraries.
+#include <LibCompiler/AR.h>
+#include <filesystem>
+
+#define kArchiverVersionStr "\e[0;97m NeKernel Archiver (Preferred Executable) %s, (c) Amlal El Mahrouss 2024-2025, all rights reserved.\n"
+
+#define StringCompare(DST, SRC) strcmp(DST, SRC)
+
+#define kStdOut (std::cout << "\e[0;31m" \
+						   << "ar64: "   \
+						   << "\e[0;97m")
+
+#define kPrintF			  printf
+#define kArchiverSplash() kPrintF(kArchiverVersionStr, kDistVersion)
+
+static LibCompiler::String				kOutput	 = "";
+static Bool								kVerbose = false;
+static std::vector<LibCompiler::String> kObjectList;
+
+/* references to other objects and to the runtime, neither is defined here. */
+static const CharType* kArDefineSymbol = ":UndefinedSymbol:";
+static const CharType* kArDynamicSym   = ":RuntimeSymbol:";
+
+/// @brief Is this record a symbol the object defines?
+static Bool ar_is_defined_symbol(const LibCompiler::Utils::AEMappedRecord& record) noexcept
+{
+	return !record.fName.empty() && record.fKind != LibCompiler::kAERelocationSection &&
+		   record.fName.find(kArDefineSymbol) == std::string_view::npos &&
+		   record.fName.find(kArDynamicSym) == std::string_view::npos;
+}
+
+/// @brief List the members and symbols of a library.
+static Int32 ar_list(const LibCompiler::String& path)
+{
+	LibCompiler::Utils::ARIndex index;
+
+	if (!index.Read(path))
+	{
+		kStdOut << "not a library: " << path << "\n";
+		return LIBCOMPILER_EXEC_ERROR;
+	}
+
+	for (auto& member : index.Members())
+	{
+		kStdOut << index.Name(member.fName) << ", " << member.fSize << " byte(s) at " << member.fOffset << "\n";
+	}
+
+	for (auto& symbol : index.Symbols())
+	{
+		kStdOut << index.Name(symbol.fName) << ": " << index.Name(index.Members()[symbol.fMember].fName) << "\n";
+	}
+
+	return LIBCOMPILER_SUCCESSS;
+}
+
+/// @brief PEF static library archiver.
+LIBCOMPILER_MODULE(Archiver64PEF)
+{
+	// argc is an int, the arguments are counted with a size_t.
+	const SizeType argument_count = static_cast<SizeType>(argc);
+
+	for (size_t archiver_arg = 1; archiver_arg < argument_count; ++archiver_arg)
+	{
+		if (StringCompare(argv[archiver_arg], "-help") == 0)
+		{
+			kArchiverSplash();
+
+			kStdOut << "-version: Show archiver version.\n";
+			kStdOut << "-help: Show archiver help.\n";
+			kStdOut << "-ar-verbose: Enable archiver trace.\n";
+			kStdOut << "-list: List the members and symbols of a library.\n";
+			kStdOut << "-output: Select the output library name.\n";
+
+			return EXIT_SUCCESS;
+		}
+		else if (StringCompare(argv[archiver_arg], "-version") == 0)
+		{
+			kArchiverSplash();
+			return EXIT_SUCCESS;
+		}
+		else if (StringCompare(argv[archiver_arg], "-ar-verbose") == 0)
+		{
+			kVerbose = true;
+
+			continue;
+		}
+		else if (StringCompare(argv[archiver_arg], "-list") == 0)
+		{
+			if ((archiver_arg + 1) >= argument_count)
+			{
+				kStdOut << "-list: expected a library.\n";
+				return EXIT_FAILURE;
+			}
+
+			return ar_list(argv[archiver_arg + 1]);
+		}
+		else if (StringCompare(argv[archiver_arg], "-output") == 0)
+		{
+			if ((archiver_arg + 1) >= argument_count)
+				continue;
+
+			kOutput = argv[archiver_arg + 1];
+			++archiver_arg;
+
+			continue;
+		}
+		else
+		{
+			if (argv[archiver_arg][0] == '-')
+			{
+				kStdOut << "unknown flag: " << argv[archiver_arg] << "\n";
+				return EXIT_FAILURE;
+			}
+
+			kObjectList.emplace_back(argv[archiver_arg]);
+
+			continue;
+		}
+	}
+
+	if (kOutput.empty())
+	{
+		kStdOut << "no output filename set." << std::endl;
+		return LIBCOMPILER_EXEC_ERROR;
+	}
+	else if (kObjectList.empty())
+	{
+		kStdOut << "no input files." << std::endl;
+		return LIBCOMPILER_EXEC_ERROR;
+	}
+
+	if (kOutput.find(kPefLibExt) == LibCompiler::String::npos)
+		kOutput += kPefLibExt;
+
+	std::vector<LibCompiler::Utils::AEMappedObject> objects;
+	std::vector<LibCompiler::ARMember>				members(kObjectList.size());
+	std::vector<std::pair<std::string_view, SizeType>> symbols;
+
+	LibCompiler::StringTable string_table;
+
+	for (SizeType member_index = 0UL; member_index < kObjectList.size(); ++member_index)
+	{
+		auto& object = objects.emplace_back(kObjectList[member_index]);
+
+		if (!object.IsValid())
+		{
+			kStdOut << "Not an object container: " << kObjectList[member_index] << std::endl;
+			return LIBCOMPILER_EXEC_ERROR;
+		}
+
+		members[member_index].fName = string_table.Intern(std::filesystem::path(kObjectList[member_index]).filename().string());
+		members[member_index].fSize = object.Bytes().size();
+		members[member_index].fArch = object.Header().fArch;
+
+		for (SizeType record_index = 0UL; record_index < object.Count(); ++record_index)
+		{
+			auto record = object.Record(record_index);
+
+			if (!ar_is_defined_symbol(record))
+				continue;
+
+			// the index is keyed by the name ld64 resolves, what follows the last '$'.
+			symbols.emplace_back(record.fName.substr(record.fName.rfind('$') + 1), member_index);
+		}
+
+		if (kVerbose)
+			kStdOut << "object " << kObjectList[member_index] << ", record count: " << object.Count() << "\n";
+	}
+
+	// sorted by name, a lookup is a binary search of the index.
+	std::stable_sort(symbols.begin(), symbols.end(), [](auto& lhs, auto& rhs) { return lhs.first < rhs.first; });
+
+	std::vector<LibCompiler::ARSymbol> index;
+
+	for (SizeType symbol_index = 0UL; symbol_index < symbols.size(); ++symbol_index)
+	{
+		auto& [name, member] = symbols[symbol_index];
+
+		// the first member defining a symbol for an architecture is the one ld64 pulls.
+		SizeType indexed = kARNoMember;
+
+		for (SizeType previous = symbol_index; previous > 0UL && symbols[previous - 1].first == name; --previous)
+		{
+			if (members[symbols[previous - 1].second].fArch == members[member].fArch)
+				indexed = symbols[previous - 1].second;
+		}
+
+		if (indexed != kARNoMember)
+		{
+			kStdOut << "warning: " << name << " is defined again by " << kObjectList[member] << ", "
+					<< kObjectList[indexed] << " is indexed.\n";
+			continue;
+		}
+
+		index.push_back(LibCompiler::ARSymbol{.fName = string_table.Intern(name), .fMember = member});
+	}
+
+	LibCompiler::ARHeader header{};
+
+	memcpy(header.fMagic, kARMagic, kARMagLen);
+
+	header.fVersion		= kARVersion;
+	header.fMemberCount = members.size();
+	header.fSymbolCount = index.size();
+	header.fStringsSize = string_table.Size();
+	header.fIndexSize	= sizeof(LibCompiler::ARHeader) + members.size() * sizeof(LibCompiler::ARMember) +
+						index.size() * sizeof(LibCompiler::ARSymbol) + string_table.Size();
+
+	// members follow the index, each on a kARAlign boundary.
+	SizeType offset = header.fIndexSize;
+
+	for (auto& member : members)
+	{
+		offset		   = (offset + kARAlign - 1) & ~SizeType(kARAlign - 1);
+		member.fOffset = offset;
+		offset += member.fSize;
+	}
+
+	std::ofstream output(kOutput, std::ofstream::binary | std::ofstream::trunc);
+
+	output.write(reinterpret_cast<char*>(&header), sizeof(LibCompiler::ARHeader));
+	output.write(reinterpret_cast<char*>(members.data()), members.size() * sizeof(LibCompiler::ARMember));
+	output.write(reinterpret_cast<char*>(index.data()), index.size() * sizeof(LibCompiler::ARSymbol));
+	output.write(string_table.Data().data(), string_table.Size());
+
+	for (SizeType member_index = 0UL; member_index < members.size(); ++member_index)
+	{
+		static const CharType kPadding[kARAlign] = {0};
+
+		output.write(kPadding, members[member_index].fOffset - SizeType(output.tellp()));
+		output.write(objects[member_index].Bytes().data(), members[member_index].fSize);
+	}
+
+	if (!output.good())
+	{
+		kStdOut << "error: can't write " << kOutput << "\n";
+		return LIBCOMPILER_FILE_NOT_FOUND;
+	}
+
+	if (kVerbose)
+		kStdOut << "wrote " << kOutput << ", " << members.size() << " member(s), " << index.size() << " symbol(s).\n";
+
+	return LIBCOMPILER_SUCCESSS;
+}
@@ -22,11 +22,13 @@
 #include <LibCompiler/Backend/64x0.h>
 #include <LibCompiler/Parser.h>
 #include <LibCompiler/AE.h>
+#include <AsmIO.h>
 #include <LibCompiler/PEF.h>
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <unordered_map>
 #include <vector>
 
 /////////////////////
@@ -49,16 +51,19 @@ static Boolean kOutputAsBinary = false;
 static UInt32 kErrorLimit		= 10;
 static UInt32 kAcceptableErrors = 0;
 
-constexpr auto c64x0IPAlignment = 0x4U;
-
 static std::size_t kCounter = 1UL;
 
-static std::uintptr_t									   kOrigin = kPefBaseOrigin;
-static std::vector<std::pair<std::string, std::uintptr_t>> kOriginLabel;
+// the offset of every label in the object's code.
+static std::unordered_map<std::string, std::uintptr_t> kOriginLabel;
 
 static bool kVerbose = false;
 
-static std::vector<e64k_num_t> kBytes;
+/// @brief the first pass only lays the code out, to know every label before encoding.
+static bool kLayoutPass = false;
+
+static Detail::AsmSectionBuffer				 kBytes;
+static std::vector<Detail::AsmSectionBuffer> kSections;
+static Detail::AsmRelocationTable			 kRelocations;
 
 static LibCompiler::AERecordHeader kCurrentRecord{
 	.fName = "", .fKind = LibCompiler::kPefCode, .fSize = 0, .fOffset = 0};
@@ -71,6 +76,7 @@ static const std::string kRelocSymbol	  = ":RuntimeSymbol:";
 
 // \brief forward decl.
 static bool asm_read_attributes(std::string& line);
+static void asm_begin_encode_pass();
 
 namespace Detail
 {
@@ -105,6 +111,9 @@ namespace Detail
 	}
 } // namespace Detail
 
+/// Do not move it on top! it uses the assembler detail namespace!
+#include <AsmUtils.h>
+
 /////////////////////////////////////////////////////////////////////////////////////////
 
 // @brief 64x0 assembler entrypoint, the program/module starts here.
@@ -167,27 +176,30 @@ LIBCOMPILER_MODULE(AssemblerMain64x0)
 
 		object_output += kOutputAsBinary ? kBinaryFileExt : kObjectFileExt;
 
-		std::ifstream file_ptr(argv[i]);
-		std::ofstream file_ptr_out(object_output, std::ofstream::binary);
+		Detail::AsmSourceFile  asm_source(argv[i]);
+		Detail::AsmObjectImage obj_image;
 
-		if (file_ptr_out.bad())
+		if (!asm_source.IsOpen())
 		{
 			if (kVerbose)
 			{
 				kStdOut << "Assembler64x0: error: " << strerror(errno) << "\n";
 			}
+
+			goto asm_fail_exit;
 		}
 
 		std::string line;
 
 		LibCompiler::AEHeader hdr{0};
 
-		memset(hdr.fPad, kAENullType, kAEPad);
+		memset(hdr.fPad, kAENullType, sizeof(hdr.fPad));
 
 		hdr.fMagic[0] = kAEMag0;
 		hdr.fMagic[1] = kAEMag1;
 		hdr.fSize	  = sizeof(LibCompiler::AEHeader);
 		hdr.fArch	  = kOutputArch;
+		hdr.fVersion  = kAEVersion;
 
 		/////////////////////////////////////////////////////////////////////////////////////////
 
@@ -197,32 +209,57 @@ LIBCOMPILER_MODULE(AssemblerMain64x0)
 
 		LibCompiler::Encoder64x0 asm64;
 
-		while (std::getline(file_ptr, line))
+		std::string_view line_view;
+
+		// pass one collects the origin of every label, pass two encodes with all of them known.
+		// so only external symbols are left for the linker to resolve.
+		for (auto layout_pass : {true, false})
 		{
-			if (auto ln = asm64.CheckLine(line, argv[i]); !ln.empty())
-			{
-				Detail::print_error(ln, argv[i]);
-				continue;
-			}
+			kLayoutPass = layout_pass;
 
-			try
-			{
-				asm_read_attributes(line);
-				asm64.WriteLine(line, argv[i]);
-			}
-			catch (const std::exception& e)
+			if (!kLayoutPass)
+				asm_begin_encode_pass();
+
+			asm_source.Rewind();
+
+			while (asm_source.ReadLine(line_view))
 			{
-				if (kVerbose)
+				line.assign(line_view);
+
+				if (auto ln = asm64.CheckLine(line, argv[i]); !ln.empty())
 				{
-					std::string what = e.what();
-					Detail::print_warning("exit because of: " + what, "LibCompiler");
+					// report it once.
+					if (kLayoutPass)
+						Detail::print_error(ln, argv[i]);
+
+					continue;
 				}
 
-				std::filesystem::remove(object_output);
-				goto asm_fail_exit;
+				try
+				{
+					asm_read_attributes(line);
+					asm64.WriteLine(line, argv[i]);
+				}
+				catch (const std::exception& e)
+				{
+					if (kVerbose)
+					{
+						std::string what = e.what();
+						Detail::print_warning("exit because of: " + what, "LibCompiler");
+					}
+
+					std::filesystem::remove(object_output);
+					goto asm_fail_exit;
+				}
 			}
 		}
 
+		Detail::asm_close_sections(kRecords, kSections, kBytes);
+
+		obj_image.Reserve(sizeof(LibCompiler::AEHeader) +
+						  (kRecords.size() + kUndefinedSymbols.size() + 1) * sizeof(LibCompiler::AERecordHeader) +
+						  Detail::asm_file_size(kSections) + kRelocations.Size());
+
 		if (!kOutputAsBinary)
 		{
 			if (kVerbose)
@@ -232,12 +269,6 @@ LIBCOMPILER_MODULE(AssemblerMain64x0)
 
 			// this is the final step, write everything to the file.
 
-			auto pos = file_ptr_out.tellp();
-
-			hdr.fCount = kRecords.size() + kUndefinedSymbols.size();
-
-			file_ptr_out << hdr;
-
 			if (kRecords.empty())
 			{
 				kStdErr << "Assembler64x0: At least one record is needed to write an object "
@@ -247,7 +278,8 @@ LIBCOMPILER_MODULE(AssemblerMain64x0)
 				return 1;
 			}
 
-			kRecords[kRecords.size() - 1].fSize = kBytes.size();
+			// names go to the string table, the header is written once every record is in it.
+			Detail::AsmRecordTable record_table;
 
 			std::size_t record_count = 0UL;
 
@@ -260,7 +292,7 @@ LIBCOMPILER_MODULE(AssemblerMain64x0)
 				rec.fOffset = record_count;
 				++record_count;
 
-				file_ptr_out << rec;
+				record_table.Add(rec);
 			}
 
 			// increment once again, so that we won't lie about the kUndefinedSymbols.
@@ -280,23 +312,27 @@ LIBCOMPILER_MODULE(AssemblerMain64x0)
 				++record_count;
 
 				memset(_record_hdr.fPad, kAENullType, kAEPad);
-				memcpy(_record_hdr.fName, sym.c_str(), sym.size());
 
-				file_ptr_out << _record_hdr;
+				record_table.Add(_record_hdr, sym);
 
 				++kCounter;
 			}
 
-			auto pos_end = file_ptr_out.tellp();
-
-			file_ptr_out.seekp(pos);
+			hdr.fCount	   = record_table.Count() + !kRelocations.Empty();
+			hdr.fStartCode = sizeof(LibCompiler::AEHeader) + record_table.Size() +
+							 !kRelocations.Empty() * sizeof(LibCompiler::AERecordHeaderV2);
+			hdr.fCodeSize  = Detail::asm_file_size(kSections);
 
-			hdr.fStartCode = pos_end;
-			hdr.fCodeSize  = kBytes.size();
+			// the relocation section follows the code.
+			if (!kRelocations.Empty())
+			{
+				if (kVerbose)
+					kStdOut << "Assembler64x0: Wrote " << kRelocations.Relocations().size() << " relocation(s) to file...\n";
 
-			file_ptr_out << hdr;
+				record_table.Add(kRelocations.Record(hdr.fStartCode + hdr.fCodeSize));
+			}
 
-			file_ptr_out.seekp(pos_end);
+			obj_image << hdr << record_table;
 		}
 		else
 		{
@@ -306,18 +342,20 @@ LIBCOMPILER_MODULE(AssemblerMain64x0)
 			}
 		}
 
-		// byte from byte, we write this.
-		for (auto& byte : kBytes)
+		for (auto& section : kSections)
+			obj_image << section;
+
+		obj_image << kRelocations;
+
+		if (!obj_image.Flush(object_output))
 		{
-			file_ptr_out.write(reinterpret_cast<const char*>(&byte), sizeof(byte));
+			kStdErr << "Assembler64x0: can't write: " << object_output << "\n";
+			goto asm_fail_exit;
 		}
 
 		if (kVerbose)
 			kStdOut << "Assembler64x0: Wrote file with program in it.\n";
 
-		file_ptr_out.flush();
-		file_ptr_out.close();
-
 		if (kVerbose)
 			kStdOut << "Assembler64x0: Exit succeeded.\n";
 
@@ -341,9 +379,11 @@ asm_fail_exit:
 
 static bool asm_read_attributes(std::string& line)
 {
+	auto tokens = Detail::asm_lex_line(line, kAsmCommentSyms);
+
 	// extern_segment is the opposite of public_segment, it signals to the ld
 	// that we need this symbol.
-	if (LibCompiler::find_word(line, "extern_segment"))
+	if (tokens.fMnemonic == "extern_segment")
 	{
 		if (kOutputAsBinary)
 		{
@@ -399,8 +439,7 @@ static bool asm_read_attributes(std::string& line)
 
 		// now we can tell the code size of the previous kCurrentRecord.
 
-		if (!kRecords.empty())
-			kRecords[kRecords.size() - 1].fSize = kBytes.size();
+		Detail::asm_open_section(kRecords, kSections, kBytes, kCurrentRecord.fKind);
 
 		memset(kCurrentRecord.fName, 0, kAESymbolLen);
 		memcpy(kCurrentRecord.fName, result.c_str(), result.size());
@@ -416,7 +455,7 @@ static bool asm_read_attributes(std::string& line)
 	// public_segment is a special keyword used by Assembler64x0 to tell the AE output stage to
 	// mark this section as a header. it currently supports .code64, .data64.,
 	// .zero64
-	else if (LibCompiler::find_word(line, "public_segment"))
+	else if (tokens.fMnemonic == "public_segment")
 	{
 		if (kOutputAsBinary)
 		{
@@ -468,13 +507,12 @@ static bool asm_read_attributes(std::string& line)
 		while (name_copy.find(" ") != std::string::npos)
 			name_copy.erase(name_copy.find(" "), 1);
 
-		kOriginLabel.push_back(std::make_pair(name_copy, kOrigin));
-		++kOrigin;
-
 		// now we can tell the code size of the previous kCurrentRecord.
 
-		if (!kRecords.empty())
-			kRecords[kRecords.size() - 1].fSize = kBytes.size();
+		Detail::asm_open_section(kRecords, kSections, kBytes, kCurrentRecord.fKind);
+
+		// the record starts where the sections before it end.
+		kOriginLabel.emplace(name_copy, Detail::asm_file_size(kSections));
 
 		memset(kCurrentRecord.fName, 0, kAESymbolLen);
 		memcpy(kCurrentRecord.fName, name.c_str(), name.size());
@@ -491,6 +529,27 @@ static bool asm_read_attributes(std::string& line)
 	return false;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @brief Start the encoding pass, only the labels of the layout pass are kept.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+static void asm_begin_encode_pass()
+{
+	kCounter = 1UL;
+
+	kBytes = Detail::AsmSectionBuffer();
+	kSections.clear();
+
+	kRecords.clear();
+	kUndefinedSymbols.clear();
+	kRelocations.Clear();
+
+	kCurrentRecord = LibCompiler::AERecordHeader{
+		.fName = "", .fKind = LibCompiler::kPefCode, .fSize = 0, .fOffset = 0};
+}
+
 // \brief algorithms and helpers.
 
 namespace Detail::algorithm
@@ -508,6 +567,13 @@ namespace Detail::algorithm
 	{
 		return std::find_if(str.begin(), str.end(), is_not_alnum_space) == str.end();
 	}
+
+	// \brief a register operand, such as r0 or r19.
+	static inline bool is_register_64x0(std::string_view operand)
+	{
+		return operand.size() > strlen(kAsmRegisterPrefix) && operand.starts_with(kAsmRegisterPrefix) &&
+			   std::all_of(operand.begin() + strlen(kAsmRegisterPrefix), operand.end(), [](char c) { return isdigit(c) != 0; });
+	}
 } // namespace Detail::algorithm
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -521,17 +587,14 @@ std::string LibCompiler::Encoder64x0::CheckLine(std::string&	   line,
 {
 	std::string err_str;
 
-	if (line.empty() || LibCompiler::find_word(line, "extern_segment") ||
-		LibCompiler::find_word(line, "public_segment") ||
-		line.find('#') != std::string::npos || LibCompiler::find_word(line, ";"))
+	auto tokens = Detail::asm_lex_line(line, kAsmCommentSyms);
+
+	if (tokens.fMnemonic.empty() || tokens.fMnemonic == "extern_segment" ||
+		tokens.fMnemonic == "public_segment" || !tokens.fComment.empty())
 	{
-		if (line.find('#') != std::string::npos)
+		if (!tokens.fComment.empty())
 		{
-			line.erase(line.find('#'));
-		}
-		else if (line.find(';') != std::string::npos)
-		{
-			line.erase(line.find(';'));
+			line.erase(tokens.fComment.data() - line.data());
 		}
 		else
 		{
@@ -556,93 +619,30 @@ std::string LibCompiler::Encoder64x0::CheckLine(std::string&	   line,
 
 	// check for a valid instruction format.
 
-	if (line.find(',') != std::string::npos)
-	{
-		if (line.find(',') + 1 == line.size())
-		{
-			err_str += "\nInstruction lacks right register, here -> ";
-			err_str += line.substr(line.find(','));
-
-			return err_str;
-		}
-		else
-		{
-			bool nothing_on_right = true;
-
-			if (line.find(',') + 1 > line.size())
-			{
-				err_str += "\nInstruction not complete, here -> ";
-				err_str += line;
-
-				return err_str;
-			}
-
-			auto substr = line.substr(line.find(',') + 1);
-
-			for (auto& ch : substr)
-			{
-				if (ch != ' ' && ch != '\t')
-				{
-					nothing_on_right = false;
-				}
-			}
-
-			// this means we found nothing after that ',' .
-			if (nothing_on_right)
-			{
-				err_str += "\nInstruction not complete, here -> ";
-				err_str += line;
-
-				return err_str;
-			}
-		}
-	}
+	if (err_str = Detail::asm_check_operands(tokens, line); !err_str.empty())
+		return err_str;
 
 	// these do take an argument.
 	std::vector<std::string> operands_inst = {"stw", "ldw", "lda", "sta"};
 
-	// these don't.
-	std::vector<std::string> filter_inst = {"jlr", "jrl", "int"};
-
-	for (auto& opcode64x0 : kOpcodes64x0)
+	if (auto opcode64x0 = find_opcode_64x0(tokens.fMnemonic); opcode64x0)
 	{
-		if (line.find(opcode64x0.fName) != std::string::npos)
-		{
-			if (opcode64x0.fFunct7 == kAsmNoArgs)
-				return err_str;
-
-			for (auto& op : operands_inst)
-			{
-				// if only the instruction was found.
-				if (line == op)
-				{
-					err_str += "\nMalformed ";
-					err_str += op;
-					err_str += " instruction, here -> ";
-					err_str += line;
-				}
-			}
+		if (opcode64x0->fFunct7 == kAsmNoArgs)
+			return err_str;
 
-			// if it is like that -> addr1, 0x0
-			if (auto it = std::find(filter_inst.begin(), filter_inst.end(),
-									opcode64x0.fName);
-				it == filter_inst.cend())
+		for (auto& op : operands_inst)
+		{
+			// if only the instruction was found.
+			if (tokens.fMnemonic == op && tokens.fOperandCount == 0)
 			{
-				if (LibCompiler::find_word(line, opcode64x0.fName))
-				{
-					if (!isspace(line[line.find(opcode64x0.fName) +
-									  strlen(opcode64x0.fName)]))
-					{
-						err_str += "\nMissing space between ";
-						err_str += opcode64x0.fName;
-						err_str += " and operands.\nhere -> ";
-						err_str += line;
-					}
-				}
+				err_str += "\nMalformed ";
+				err_str += op;
+				err_str += " instruction, here -> ";
+				err_str += line;
 			}
-
-			return err_str;
 		}
+
+		return err_str;
 	}
 
 	err_str += "Unrecognized instruction: " + line;
@@ -674,7 +674,7 @@ bool LibCompiler::Encoder64x0::WriteNumber(const std::size_t& pos,
 
 		for (char& i : num.number)
 		{
-			kBytes.push_back(i);
+			kBytes.Append(i);
 		}
 
 		if (kVerbose)
@@ -707,7 +707,7 @@ bool LibCompiler::Encoder64x0::WriteNumber(const std::size_t& pos,
 
 		for (char& i : num.number)
 		{
-			kBytes.push_back(i);
+			kBytes.Append(i);
 		}
 
 		return true;
@@ -734,7 +734,7 @@ bool LibCompiler::Encoder64x0::WriteNumber(const std::size_t& pos,
 
 		for (char& i : num.number)
 		{
-			kBytes.push_back(i);
+			kBytes.Append(i);
 		}
 
 		return true;
@@ -758,7 +758,7 @@ bool LibCompiler::Encoder64x0::WriteNumber(const std::size_t& pos,
 
 	for (char& i : num.number)
 	{
-		kBytes.push_back(i);
+		kBytes.Append(i);
 	}
 
 	if (kVerbose)
@@ -779,336 +779,201 @@ bool LibCompiler::Encoder64x0::WriteNumber(const std::size_t& pos,
 bool LibCompiler::Encoder64x0::WriteLine(std::string&		line,
 										 const std::string& file)
 {
-	if (LibCompiler::find_word(line, "public_segment "))
+	auto tokens = Detail::asm_lex_line(line, kAsmCommentSyms);
+
+	if (tokens.fMnemonic == "public_segment")
 		return true;
 
-	for (auto& opcode64x0 : kOpcodes64x0)
+	auto opcode64x0 = find_opcode_64x0(tokens.fMnemonic);
+
+	// strict check here
+	if (!opcode64x0 || !Detail::algorithm::is_valid_64x0(line))
+		return true;
+
+	std::string name(opcode64x0->fName);
+
+	// loads and stores take one operand that isn't a register, a number or a label.
+	bool		is_load_store = name == "stw" || name == "ldw" || name == "lda" || name == "sta";
+	std::string jump_label;
+
+	kBytes.Append(opcode64x0->fOpcode);
+	kBytes.Append(opcode64x0->fFunct3);
+	kBytes.Append(opcode64x0->fFunct7);
+
+	// check funct7 type.
+	switch (opcode64x0->fFunct7)
 	{
-		// strict check here
-		if (LibCompiler::find_word(line, opcode64x0.fName) &&
-			Detail::algorithm::is_valid_64x0(line))
-		{
-			std::string name(opcode64x0.fName);
-			std::string jump_label, cpy_jump_label;
+	// reg to reg means register to register transfer operation.
+	case kAsmRegToReg:
+	case kAsmImmediate: {
+		// \brief how many registers we found.
+		std::size_t found_some = 0UL;
 
-			kBytes.emplace_back(opcode64x0.fOpcode);
-			kBytes.emplace_back(opcode64x0.fFunct3);
-			kBytes.emplace_back(opcode64x0.fFunct7);
+		for (std::size_t operand_index = 0UL; operand_index < tokens.fOperandCount; ++operand_index)
+		{
+			auto operand = tokens.fOperands[operand_index];
 
-			// check funct7 type.
-			switch (opcode64x0.fFunct7)
+			if (!Detail::algorithm::is_register_64x0(operand))
 			{
-			// reg to reg means register to register transfer operation.
-			case kAsmRegToReg:
-			case kAsmImmediate: {
-				// \brief how many registers we found.
-				std::size_t found_some = 0UL;
-
-				for (size_t line_index = 0UL; line_index < line.size();
-					 line_index++)
-				{
-					if (line[line_index] == kAsmRegisterPrefix[0] &&
-						isdigit(line[line_index + 1]))
-					{
-						std::string register_syntax = kAsmRegisterPrefix;
-						register_syntax += line[line_index + 1];
-
-						if (isdigit(line[line_index + 2]))
-							register_syntax += line[line_index + 2];
-
-						std::string reg_str;
-						reg_str += line[line_index + 1];
-
-						if (isdigit(line[line_index + 2]))
-							reg_str += line[line_index + 2];
-
-						// it ranges from r0 to r19
-						// something like r190 doesn't exist in the instruction set.
-						if (kOutputArch == LibCompiler::kPefArch64000)
-						{
-							if (isdigit(line[line_index + 3]) &&
-								isdigit(line[line_index + 2]))
-							{
-								reg_str += line[line_index + 3];
-								Detail::print_error(
-									"invalid register index, r" + reg_str +
-										"\nnote: The 64x0 accepts registers from r0 to r20.",
-									file);
-								throw std::runtime_error("invalid_register_index");
-							}
-						}
-
-						// finally cast to a size_t
-						std::size_t reg_index = strtol(reg_str.c_str(), nullptr, 10);
-
-						if (reg_index > kAsmRegisterLimit)
-						{
-							Detail::print_error("invalid register index, r" + reg_str,
-												file);
-							throw std::runtime_error("invalid_register_index");
-						}
-
-						kBytes.emplace_back(reg_index);
-						++found_some;
-
-						if (kVerbose)
-						{
-							kStdOut << "Assembler64x0: Register found: " << register_syntax << "\n";
-							kStdOut << "Assembler64x0: Register amount in instruction: "
-									<< found_some << "\n";
-						}
-					}
-				}
-
-				// we're not in immediate addressing, reg to reg.
-				if (opcode64x0.fFunct7 != kAsmImmediate)
-				{
-					// remember! register to register!
-					if (found_some == 1)
-					{
-						Detail::print_error(
-							"Too few registers.\ntip: each Assembler64x0 register "
-							"starts with 'r'.\nline: " +
-								line,
-							file);
-						throw std::runtime_error("not_a_register");
-					}
-				}
+				if (!is_load_store)
+					continue;
 
-				if (found_some < 1 && name != "ldw" && name != "lda" &&
-					name != "stw")
+				if (!jump_label.empty())
 				{
 					Detail::print_error(
-						"invalid combination of opcode and registers.\nline: " + line,
+						"invalid combination of opcode and operands.\nhere -> " + line,
 						file);
-					throw std::runtime_error("invalid_comb_op_reg");
-				}
-				else if (found_some == 1 && name == "add")
-				{
-					Detail::print_error(
-						"invalid combination of opcode and registers.\nline: " + line,
-						file);
-					throw std::runtime_error("invalid_comb_op_reg");
-				}
-				else if (found_some == 1 && name == "sub")
-				{
-					Detail::print_error(
-						"invalid combination of opcode and registers.\nline: " + line,
-						file);
-					throw std::runtime_error("invalid_comb_op_reg");
+					throw std::runtime_error("invalid_comb_op_ops");
 				}
 
-				if (found_some > 0 && name == "pop")
-				{
-					Detail::print_error(
-						"invalid combination for opcode 'pop'.\ntip: it expects "
-						"nothing.\nline: " +
-							line,
-						file);
-					throw std::runtime_error("invalid_comb_op_pop");
-				}
-			}
-			default:
-				break;
+				jump_label = operand;
+				continue;
 			}
 
-			// try to fetch a number from the name
-			if (name == "stw" || name == "ldw" || name == "lda" || name == "sta")
-			{
-				auto where_string = name;
-
-				// if we load something, we'd need it's symbol/literal
-				if (name == "stw" || name == "sta" || name == "ldw" || name == "lda" ||
-					name == "sta")
-					where_string = ",";
+			std::string reg_str(operand.substr(strlen(kAsmRegisterPrefix)));
 
-				jump_label = line;
-
-				auto found_sym = false;
-
-				while (jump_label.find(where_string) != std::string::npos)
-				{
-					jump_label = jump_label.substr(jump_label.find(where_string) +
-												   where_string.size());
-
-					while (jump_label.find(" ") != std::string::npos)
-					{
-						jump_label.erase(jump_label.find(" "), 1);
-					}
-
-					if (jump_label[0] != kAsmRegisterPrefix[0] &&
-						!isdigit(jump_label[1]))
-					{
-						if (found_sym)
-						{
-							Detail::print_error(
-								"invalid combination of opcode and operands.\nhere -> " +
-									jump_label,
-								file);
-							throw std::runtime_error("invalid_comb_op_ops");
-						}
-						else
-						{
-							// death trap installed.
-							found_sym = true;
-						}
-					}
-				}
+			// it ranges from r0 to r19
+			// something like r190 doesn't exist in the instruction set.
+			if (kOutputArch == LibCompiler::kPefArch64000 && reg_str.size() > 2)
+			{
+				Detail::print_error(
+					"invalid register index, r" + reg_str +
+						"\nnote: The 64x0 accepts registers from r0 to r20.",
+					file);
+				throw std::runtime_error("invalid_register_index");
+			}
 
-				cpy_jump_label = jump_label;
+			// finally cast to a size_t
+			std::size_t reg_index = strtol(reg_str.c_str(), nullptr, 10);
 
-				// replace any spaces with $
-				if (jump_label[0] == ' ')
-				{
-					while (jump_label.find(' ') != std::string::npos)
-					{
-						if (isalnum(jump_label[0]) || isdigit(jump_label[0]))
-							break;
-
-						jump_label.erase(jump_label.find(' '), 1);
-					}
-				}
+			if (reg_index > kAsmRegisterLimit)
+			{
+				Detail::print_error("invalid register index, r" + reg_str,
+									file);
+				throw std::runtime_error("invalid_register_index");
+			}
 
-				if (!this->WriteNumber(0, jump_label))
-				{
-					// sta expects this: sta 0x000000, r0
-					if (name == "sta")
-					{
-						Detail::print_error(
-							"invalid combination of opcode and operands.\nHere ->" + line,
-							file);
-						throw std::runtime_error("invalid_comb_op_ops");
-					}
-				}
-				else
-				{
-					if (name == "sta" &&
-						cpy_jump_label.find("extern_segment ") != std::string::npos)
-					{
-						Detail::print_error("invalid usage extern_segment on 'sta', here: " + line,
-											file);
-						throw std::runtime_error("invalid_sta_usage");
-					}
-				}
+			kBytes.Append(reg_index);
+			++found_some;
 
-				goto asm_write_label;
+			if (kVerbose)
+			{
+				kStdOut << "Assembler64x0: Register found: " << operand << "\n";
+				kStdOut << "Assembler64x0: Register amount in instruction: "
+						<< found_some << "\n";
 			}
+		}
 
-			// This is the case where we jump to a label, it is also used as a goto.
-			if (name == "lda" || name == "sta")
+		// we're not in immediate addressing, reg to reg.
+		if (opcode64x0->fFunct7 != kAsmImmediate)
+		{
+			// remember! register to register!
+			if (found_some == 1)
 			{
-			asm_write_label:
-				if (cpy_jump_label.find('\n') != std::string::npos)
-					cpy_jump_label.erase(cpy_jump_label.find('\n'), 1);
+				Detail::print_error(
+					"Too few registers.\ntip: each Assembler64x0 register "
+					"starts with 'r'.\nline: " +
+						line,
+					file);
+				throw std::runtime_error("not_a_register");
+			}
+		}
 
-				if (cpy_jump_label.find("extern_segment") != std::string::npos)
-				{
-					cpy_jump_label.erase(cpy_jump_label.find("extern_segment"), strlen("extern_segment"));
+		if (found_some < 1 && name != "ldw" && name != "lda" &&
+			name != "stw")
+		{
+			Detail::print_error(
+				"invalid combination of opcode and registers.\nline: " + line,
+				file);
+			throw std::runtime_error("invalid_comb_op_reg");
+		}
+		else if (found_some == 1 && (name == "add" || name == "sub"))
+		{
+			Detail::print_error(
+				"invalid combination of opcode and registers.\nline: " + line,
+				file);
+			throw std::runtime_error("invalid_comb_op_reg");
+		}
 
-					if (name == "sta")
-					{
-						Detail::print_error("extern_segment is not allowed on a sta operation.",
-											file);
-						throw std::runtime_error("extern_segment_sta_op");
-					}
-					else
-					{
-						goto asm_end_label_cpy;
-					}
-				}
+		if (found_some > 0 && name == "pop")
+		{
+			Detail::print_error(
+				"invalid combination for opcode 'pop'.\ntip: it expects "
+				"nothing.\nline: " +
+					line,
+				file);
+			throw std::runtime_error("invalid_comb_op_pop");
+		}
+	}
+	default:
+		break;
+	}
 
-				if (name == "lda" || name == "sta")
-				{
-					for (auto& label : kOriginLabel)
-					{
-						if (cpy_jump_label == label.first)
-						{
-							if (kVerbose)
-							{
-								kStdOut << "Assembler64x0: Replace label " << cpy_jump_label
-										<< " to address: " << label.second << std::endl;
-							}
-
-							LibCompiler::NumberCast64 num(label.second);
-
-							for (auto& num : num.number)
-							{
-								kBytes.push_back(num);
-							}
-
-							goto asm_end_label_cpy;
-						}
-					}
+	// a word can be loaded or stored through registers only.
+	if (!is_load_store || (jump_label.empty() && (name == "ldw" || name == "stw")))
+		return true;
 
-					if (cpy_jump_label[0] == '0')
-					{
-						switch (cpy_jump_label[1])
-						{
-						case 'x':
-						case 'o':
-						case 'b':
-							if (this->WriteNumber(0, cpy_jump_label))
-								goto asm_end_label_cpy;
-
-							break;
-						default:
-							break;
-						}
-
-						if (isdigit(cpy_jump_label[0]))
-						{
-							if (this->WriteNumber(0, cpy_jump_label))
-								goto asm_end_label_cpy;
-
-							break;
-						}
-					}
-				}
+	if (jump_label.empty())
+	{
+		Detail::print_error("label is empty, can't jump on it.", file);
+		throw std::runtime_error("label_empty");
+	}
 
-				if (cpy_jump_label.size() < 1)
-				{
-					Detail::print_error("label is empty, can't jump on it.", file);
-					throw std::runtime_error("label_empty");
-				}
+	// a number is written as is.
+	if (this->WriteNumber(0, jump_label))
+		return true;
 
-				/// don't go any further if:
-				/// load word (ldw) or store word. (stw)
+	// sta expects this: sta 0x000000, r0
+	if (name == "sta")
+	{
+		Detail::print_error(
+			"invalid combination of opcode and operands.\nHere ->" + line,
+			file);
+		throw std::runtime_error("invalid_comb_op_ops");
+	}
 
-				if (name == "ldw" || name == "stw")
-					break;
+	/// don't go any further if:
+	/// load word (ldw) or store word. (stw)
 
-				auto mld_reloc_str = std::to_string(cpy_jump_label.size());
-				mld_reloc_str += kUndefinedSymbol;
-				mld_reloc_str += cpy_jump_label;
+	if (name == "ldw" || name == "stw")
+		return true;
 
-				bool ignore_back_slash = false;
+	// This is the case where we jump to a label, it is also used as a goto.
+	if (jump_label.starts_with("extern_segment"))
+	{
+		jump_label.erase(0, strlen("extern_segment"));
+		jump_label.erase(0, jump_label.find_first_not_of(" \t"));
+	}
 
-				for (auto& reloc_chr : mld_reloc_str)
-				{
-					if (reloc_chr == '\\')
-					{
-						ignore_back_slash = true;
-						continue;
-					}
+	UIntPtr address = 0UL;
 
-					if (ignore_back_slash)
-					{
-						ignore_back_slash = false;
-						continue;
-					}
+	if (auto label = kOriginLabel.find(jump_label); label != kOriginLabel.end())
+	{
+		if (kVerbose && !kLayoutPass)
+		{
+			kStdOut << "Assembler64x0: Replace label " << jump_label
+					<< " to offset: " << label->second << std::endl;
+		}
 
-					kBytes.push_back(reloc_chr);
-				}
+		// the address holds if the code is at the origin, the linker moves it along with the label.
+		address = kPefBaseOrigin + label->second;
+	}
+	else if (kOutputAsBinary && !kLayoutPass)
+	{
+		// not a label of this source, the linker patches its address in.
+		// the layout pass doesn't know every label yet.
+		Detail::print_error("undefined label in flat binary mode: " + jump_label, file);
+		throw std::runtime_error("undefined_label_bin");
+	}
 
-				kBytes.push_back('\0');
-				goto asm_end_label_cpy;
-			}
+	kRelocations.Add(Detail::asm_file_size(kSections) + kBytes.FileSize(),
+					 LibCompiler::kAERelocationAbs64, jump_label);
 
-		asm_end_label_cpy:
-			kOrigin += c64x0IPAlignment;
+	LibCompiler::NumberCast64 num(address);
 
-			break;
-		}
+	for (auto& num : num.number)
+	{
+		kBytes.Append(num);
 	}
 
 	return true;
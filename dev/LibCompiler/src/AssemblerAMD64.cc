@@ -23,12 +23,14 @@
 
 #define __ASM_NEED_AMD64__ 1
 
-#define kAssemblerPragmaSymStr "#"
-#define kAssemblerPragmaSym	   '#'
+#define kAssemblerPragmaSymStr	"#"
+#define kAssemblerPragmaSym		'#'
+#define kAssemblerCommentSymStr ";"
 
 #include <LibCompiler/Backend/amd64.h>
 #include <LibCompiler/Parser.h>
 #include <LibCompiler/AE.h>
+#include <AsmIO.h>
 #include <LibCompiler/PEF.h>
 #include <algorithm>
 #include <cstdlib>
@@ -69,7 +71,8 @@ static std::int32_t kRegisterBitWidth = 16U;
 
 static bool kVerbose = false;
 
-static std::vector<i64_byte_t> kAppBytes;
+static Detail::AsmSectionBuffer kAppBytes;
+static std::vector<Detail::AsmSectionBuffer> kSections;
 
 static LibCompiler::AERecordHeader kCurrentRecord{
 	.fName = "", .fKind = LibCompiler::kPefCode, .fSize = 0, .fOffset = 0};
@@ -87,283 +90,270 @@ static bool asm_read_attributes(std::string& line);
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
-// @brief AMD64 assembler entrypoint, the program/module starts here.
+// @brief Assemble a source into an object, named after asm_input.
+// @param asm_source a mapped file, or the pipe of the previous stage.
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
-LIBCOMPILER_MODULE(AssemblerMainAMD64)
+template <typename AsmSource>
+static Int32 asm_assemble(AsmSource& asm_source, const std::string& asm_input)
 {
-	//////////////// CPU OPCODES BEGIN ////////////////
-
-	std::string opcodes_jump[kJumpLimit] = {
-		"ja", "jae", "jb", "jbe", "jc", "je", "jg", "jge", "jl", "jle",
-		"jna", "jnae", "jnb", "jnbe", "jnc", "jne", "jng", "jnge", "jnl", "jnle",
-		"jno", "jnp", "jns", "jnz", "jo", "jp", "jpe", "jpo", "js", "jz"};
+	std::string object_output(asm_input);
 
-	for (i64_hword_t i = 0; i < kJumpLimit; i++)
+	for (auto& ext : kAsmFileExts)
 	{
-		CpuOpcodeAMD64 code{
-			.fName	 = opcodes_jump[i],
-			.fOpcode = static_cast<i64_hword_t>(kAsmJumpOpcode + i)};
-		kOpcodesAMD64.push_back(code);
+		if (object_output.ends_with(ext))
+		{
+			object_output.erase(object_output.find(ext), std::strlen(ext));
+			break;
+		}
 	}
 
-	CpuOpcodeAMD64 code{.fName = "jcxz", .fOpcode = 0xE3};
-	kOpcodesAMD64.push_back(code);
+	object_output += kOutputAsBinary ? kBinaryFileExt : kObjectFileExt;
 
-	for (i64_hword_t i = kJumpLimitStandard; i < kJumpLimitStandardLimit; i++)
+	Detail::AsmObjectImage obj_image;
+
+	kStdOut << "AssemblerAMD64: Assembling: " << asm_input << "\n";
+
+	if (!asm_source.IsOpen())
 	{
-		CpuOpcodeAMD64 code{.fName = "jmp", .fOpcode = i};
-		kOpcodesAMD64.push_back(code);
+		if (kVerbose)
+		{
+			kStdOut << "AssemblerAMD64: error: " << strerror(errno) << "\n";
+		}
+
+		return 1;
 	}
 
-	CpuOpcodeAMD64 lahf{.fName = "lahf", .fOpcode = 0x9F};
-	kOpcodesAMD64.push_back(lahf);
+	std::string line;
 
-	CpuOpcodeAMD64 lds{.fName = "lds", .fOpcode = 0xC5};
-	kOpcodesAMD64.push_back(lds);
+	LibCompiler::AEHeader hdr{0};
 
-	CpuOpcodeAMD64 lea{.fName = "lea", .fOpcode = 0x8D};
-	kOpcodesAMD64.push_back(lea);
+	memset(hdr.fPad, kAENullType, sizeof(hdr.fPad));
 
-	CpuOpcodeAMD64 nop{.fName = "nop", .fOpcode = 0x90};
-	kOpcodesAMD64.push_back(nop);
+	hdr.fMagic[0] = kAEMag0;
+	hdr.fMagic[1] = kAEMag1;
+	hdr.fSize	  = sizeof(LibCompiler::AEHeader);
+	hdr.fArch	  = kOutputArch;
+	hdr.fVersion  = kAEVersion;
 
-	//////////////// CPU OPCODES END ////////////////
+	/////////////////////////////////////////////////////////////////////////////////////////
 
-	for (size_t i = 1; i < argc; ++i)
+	// COMPILATION LOOP
+
+	/////////////////////////////////////////////////////////////////////////////////////////
+
+	LibCompiler::EncoderAMD64 asm64;
+
+	if (kVerbose)
 	{
-		if (argv[i][0] == '-')
-		{
-			if (strcmp(argv[i], "--amd64:ver") == 0 || strcmp(argv[i], "--amd64:v") == 0)
-			{
-				kStdOut << "AssemblerAMD64: AMD64 Assembler Driver.\nAssemblerAMD64: v1.10\nAssemblerAMD64: Copyright "
-						   "(c) Amlal El Mahrouss\n";
-				return 0;
-			}
-			else if (strcmp(argv[i], "--amd64:h") == 0)
-			{
-				kStdOut << "AssemblerAMD64: AMD64 Assembler Driver.\nAssemblerAMD64: Copyright (c) 2024 "
-						   "Amlal El Mahrouss\n";
-				kStdOut << "--version: Print program version.\n";
-				kStdOut << "--verbose: Print verbose output.\n";
-				kStdOut << "--binary: Output as flat binary.\n";
+		kStdOut << "Compiling: " + asm_input << "\n";
+		kStdOut << "From: " + line << "\n";
+	}
 
-				return 0;
-			}
-			else if (strcmp(argv[i], "--amd64:binary") == 0)
-			{
-				kOutputAsBinary = true;
-				continue;
-			}
-			else if (strcmp(argv[i], "--amd64:verbose") == 0)
-			{
-				kVerbose = true;
-				continue;
-			}
+	std::string_view line_view;
 
-			kStdOut << "AssemblerAMD64: ignore " << argv[i] << "\n";
+	while (asm_source.ReadLine(line_view))
+	{
+		line.assign(line_view);
+
+		if (auto ln = asm64.CheckLine(line, asm_input); !ln.empty())
+		{
+			Detail::print_error(ln, asm_input);
 			continue;
 		}
 
-		if (!std::filesystem::exists(argv[i]))
+		try
 		{
-			kStdOut << "AssemblerAMD64: can't open: " << argv[i] << std::endl;
-			goto asm_fail_exit;
+			asm_read_attributes(line);
+			asm64.WriteLine(line, asm_input);
 		}
-
-		std::string object_output(argv[i]);
-		std::string asm_input(argv[i]);
-
-		for (auto& ext : kAsmFileExts)
+		catch (const std::exception& e)
 		{
-			if (object_output.ends_with(ext))
+			if (kVerbose)
 			{
-				object_output.erase(object_output.find(ext), std::strlen(ext));
-				break;
+				std::string what = e.what();
+				Detail::print_warning("exit because of: " + what, "LibCompiler");
 			}
-		}
-
-		object_output += kOutputAsBinary ? kBinaryFileExt : kObjectFileExt;
-
-		std::ifstream file_ptr(argv[i]);
-		std::ofstream file_ptr_out(object_output, std::ofstream::binary);
-
-		kStdOut << "AssemblerAMD64: Assembling: " << argv[i] << "\n";
 
-		if (file_ptr_out.bad())
-		{
-			if (kVerbose)
+			try
+			{
+				std::filesystem::remove(object_output);
+			}
+			catch (...)
 			{
-				kStdOut << "AssemblerAMD64: error: " << strerror(errno) << "\n";
 			}
 
 			return 1;
 		}
+	}
 
-		std::string line;
-
-		LibCompiler::AEHeader hdr{0};
+	Detail::asm_close_sections(kRecords, kSections, kAppBytes);
 
-		memset(hdr.fPad, kAENullType, kAEPad);
+	obj_image.Reserve(sizeof(LibCompiler::AEHeader) +
+					  (kRecords.size() + kUndefinedSymbols.size()) * sizeof(LibCompiler::AERecordHeader) +
+					  Detail::asm_file_size(kSections));
 
-		hdr.fMagic[0] = kAEMag0;
-		hdr.fMagic[1] = kAEMag1;
-		hdr.fSize	  = sizeof(LibCompiler::AEHeader);
-		hdr.fArch	  = kOutputArch;
+	if (!kOutputAsBinary)
+	{
+		if (kVerbose)
+		{
+			kStdOut << "AssemblerAMD64: Writing object file...\n";
+		}
 
-		/////////////////////////////////////////////////////////////////////////////////////////
+		// this is the final step, write everything to the file.
 
-		// COMPILATION LOOP
+		if (kRecords.empty())
+		{
+			kStdErr << "AssemblerAMD64: At least one record is needed to write an object "
+					   "file.\nAssemblerAMD64: Make one using `public_segment .code64 foo_bar`.\n";
 
-		/////////////////////////////////////////////////////////////////////////////////////////
+			std::filesystem::remove(object_output);
+			return 1;
+		}
 
-		LibCompiler::EncoderAMD64 asm64;
+		// names go to the string table, the header is written once every record is in it.
+		Detail::AsmRecordTable record_table;
 
-		if (kVerbose)
-		{
-			kStdOut << "Compiling: " + asm_input << "\n";
-			kStdOut << "From: " + line << "\n";
-		}
+		std::size_t record_count = 0UL;
 
-		while (std::getline(file_ptr, line))
+		for (auto& rec : kRecords)
 		{
-			if (auto ln = asm64.CheckLine(line, argv[i]); !ln.empty())
-			{
-				Detail::print_error(ln, argv[i]);
-				continue;
-			}
-
-			try
-			{
-				asm_read_attributes(line);
-				asm64.WriteLine(line, argv[i]);
-			}
-			catch (const std::exception& e)
-			{
-				if (kVerbose)
-				{
-					std::string what = e.what();
-					Detail::print_warning("exit because of: " + what, "LibCompiler");
-				}
+			if (kVerbose)
+				kStdOut << "AssemblerAMD64: Wrote record " << rec.fName << " to file...\n";
 
-				try
-				{
-					std::filesystem::remove(object_output);
-				}
-				catch (...)
-				{
-				}
+			rec.fFlags |= LibCompiler::kKindRelocationAtRuntime;
+			rec.fOffset = record_count;
+			++record_count;
 
-				goto asm_fail_exit;
-			}
+			record_table.Add(rec);
 		}
 
-		if (!kOutputAsBinary)
+		// increment once again, so that we won't lie about the kUndefinedSymbols.
+		++record_count;
+
+		for (auto& sym : kUndefinedSymbols)
 		{
-			if (kVerbose)
-			{
-				kStdOut << "AssemblerAMD64: Writing object file...\n";
-			}
+			LibCompiler::AERecordHeader _record_hdr{0};
 
-			// this is the final step, write everything to the file.
+			if (kVerbose)
+				kStdOut << "AssemblerAMD64: Wrote symbol " << sym << " to file...\n";
 
-			auto pos = file_ptr_out.tellp();
+			_record_hdr.fKind	= kAENullType;
+			_record_hdr.fSize	= sym.size();
+			_record_hdr.fOffset = record_count;
 
-			hdr.fCount = kRecords.size() + kUndefinedSymbols.size();
+			++record_count;
 
-			file_ptr_out << hdr;
+			memset(_record_hdr.fPad, kAENullType, kAEPad);
 
-			if (kRecords.empty())
-			{
-				kStdErr << "AssemblerAMD64: At least one record is needed to write an object "
-						   "file.\nAssemblerAMD64: Make one using `public_segment .code64 foo_bar`.\n";
+			record_table.Add(_record_hdr, sym);
 
-				std::filesystem::remove(object_output);
-				return 1;
-			}
+			++kCounter;
+		}
 
-			kRecords[kRecords.size() - 1].fSize = kAppBytes.size();
+		hdr.fCount	   = record_table.Count();
+		hdr.fStartCode = sizeof(LibCompiler::AEHeader) + record_table.Size();
+		hdr.fCodeSize  = Detail::asm_file_size(kSections);
 
-			std::size_t record_count = 0UL;
+		obj_image << hdr << record_table;
+	}
+	else
+	{
+		if (kVerbose)
+		{
+			kStdOut << "AssemblerAMD64: Write raw binary...\n";
+		}
+	}
 
-			for (auto& rec : kRecords)
-			{
-				if (kVerbose)
-					kStdOut << "AssemblerAMD64: Wrote record " << rec.fName << " to file...\n";
+	for (auto& section : kSections)
+		obj_image << section;
 
-				rec.fFlags |= LibCompiler::kKindRelocationAtRuntime;
-				rec.fOffset = record_count;
-				++record_count;
+	if (!obj_image.Flush(object_output))
+	{
+		kStdErr << "AssemblerAMD64: can't write: " << object_output << "\n";
+		return 1;
+	}
 
-				file_ptr_out << rec;
-			}
+	if (kVerbose)
+		kStdOut << "AssemblerAMD64: Wrote file with program in it.\n";
 
-			// increment once again, so that we won't lie about the kUndefinedSymbols.
-			++record_count;
+	if (kVerbose)
+		kStdOut << "AssemblerAMD64: Exit succeeded.\n";
 
-			for (auto& sym : kUndefinedSymbols)
-			{
-				LibCompiler::AERecordHeader _record_hdr{0};
+	return 0;
+}
 
-				if (kVerbose)
-					kStdOut << "AssemblerAMD64: Wrote symbol " << sym << " to file...\n";
+/////////////////////////////////////////////////////////////////////////////////////////
 
-				_record_hdr.fKind	= kAENullType;
-				_record_hdr.fSize	= sym.size();
-				_record_hdr.fOffset = record_count;
+// @brief Pipeline entrypoint, assemble the lines of in.
 
-				++record_count;
+/////////////////////////////////////////////////////////////////////////////////////////
 
-				memset(_record_hdr.fPad, kAENullType, kAEPad);
-				memcpy(_record_hdr.fName, sym.c_str(), sym.size());
+LC_IMPORT_C int AssemblerAMD64Pipe(const char* file, LibCompiler::LinePipe* in)
+{
+	Detail::AsmSourcePipe asm_source(*in);
 
-				file_ptr_out << _record_hdr;
+	auto code = asm_assemble(asm_source, file);
 
-				++kCounter;
-			}
+	in->Close();
 
-			auto pos_end = file_ptr_out.tellp();
+	return code;
+}
 
-			file_ptr_out.seekp(pos);
+/////////////////////////////////////////////////////////////////////////////////////////
 
-			hdr.fStartCode = pos_end;
-			hdr.fCodeSize  = kAppBytes.size();
+// @brief AMD64 assembler entrypoint, the program/module starts here.
 
-			file_ptr_out << hdr;
+/////////////////////////////////////////////////////////////////////////////////////////
 
-			file_ptr_out.seekp(pos_end);
-		}
-		else
+LIBCOMPILER_MODULE(AssemblerMainAMD64)
+{
+	for (size_t i = 1; i < argc; ++i)
+	{
+		if (argv[i][0] == '-')
 		{
-			if (kVerbose)
+			if (strcmp(argv[i], "--amd64:ver") == 0 || strcmp(argv[i], "--amd64:v") == 0)
 			{
-				kStdOut << "AssemblerAMD64: Write raw binary...\n";
+				kStdOut << "AssemblerAMD64: AMD64 Assembler Driver.\nAssemblerAMD64: v1.10\nAssemblerAMD64: Copyright "
+						   "(c) Amlal El Mahrouss\n";
+				return 0;
 			}
-		}
+			else if (strcmp(argv[i], "--amd64:h") == 0)
+			{
+				kStdOut << "AssemblerAMD64: AMD64 Assembler Driver.\nAssemblerAMD64: Copyright (c) 2024 "
+						   "Amlal El Mahrouss\n";
+				kStdOut << "--version: Print program version.\n";
+				kStdOut << "--verbose: Print verbose output.\n";
+				kStdOut << "--binary: Output as flat binary.\n";
 
-		// byte from byte, we write this.
-		for (auto& byte : kAppBytes)
-		{
-			if (byte == 0)
+				return 0;
+			}
+			else if (strcmp(argv[i], "--amd64:binary") == 0)
+			{
+				kOutputAsBinary = true;
 				continue;
-
-			if (byte == 0xFF)
+			}
+			else if (strcmp(argv[i], "--amd64:verbose") == 0)
 			{
-				byte = 0;
+				kVerbose = true;
+				continue;
 			}
 
-			file_ptr_out << reinterpret_cast<const char*>(&byte)[0];
+			kStdOut << "AssemblerAMD64: ignore " << argv[i] << "\n";
+			continue;
 		}
 
-		if (kVerbose)
-			kStdOut << "AssemblerAMD64: Wrote file with program in it.\n";
+		if (!std::filesystem::exists(argv[i]))
+		{
+			kStdOut << "AssemblerAMD64: can't open: " << argv[i] << std::endl;
+			goto asm_fail_exit;
+		}
 
-		file_ptr_out.flush();
-		file_ptr_out.close();
+		Detail::AsmSourceFile asm_source(argv[i]);
 
-		if (kVerbose)
-			kStdOut << "AssemblerAMD64: Exit succeeded.\n";
+		if (asm_assemble(asm_source, argv[i]) != 0)
+			goto asm_fail_exit;
 
 		return 0;
 	}
@@ -385,9 +375,11 @@ asm_fail_exit:
 
 static bool asm_read_attributes(std::string& line)
 {
+	auto tokens = Detail::asm_lex_line(line, kAssemblerCommentSymStr, kAssemblerPragmaSym);
+
 	// extern_segment is the opposite of public_segment, it signals to the ld
 	// that we need this symbol.
-	if (LibCompiler::find_word(line, "extern_segment"))
+	if (tokens.fMnemonic == "extern_segment")
 	{
 		if (kOutputAsBinary)
 		{
@@ -441,8 +433,7 @@ static bool asm_read_attributes(std::string& line)
 
 		// now we can tell the code size of the previous kCurrentRecord.
 
-		if (!kRecords.empty())
-			kRecords[kRecords.size() - 1].fSize = kAppBytes.size();
+		Detail::asm_open_section(kRecords, kSections, kAppBytes, kCurrentRecord.fKind);
 
 		memset(kCurrentRecord.fName, 0, kAESymbolLen);
 		memcpy(kCurrentRecord.fName, result.c_str(), result.size());
@@ -458,7 +449,7 @@ static bool asm_read_attributes(std::string& line)
 	// public_segment is a special keyword used by AssemblerAMD64 to tell the AE output stage to
 	// mark this section as a header. it currently supports .code64, .data64 and
 	// .zero64.
-	else if (LibCompiler::find_word(line, "public_segment"))
+	else if (tokens.fMnemonic == "public_segment")
 	{
 		if (kOutputAsBinary)
 		{
@@ -523,8 +514,7 @@ static bool asm_read_attributes(std::string& line)
 
 		// now we can tell the code size of the previous kCurrentRecord.
 
-		if (!kRecords.empty())
-			kRecords[kRecords.size() - 1].fSize = kAppBytes.size();
+		Detail::asm_open_section(kRecords, kSections, kAppBytes, kCurrentRecord.fKind);
 
 		memset(kCurrentRecord.fName, 0, kAESymbolLen);
 		memcpy(kCurrentRecord.fName, name.c_str(), name.size());
@@ -561,6 +551,7 @@ namespace Detail::algorithm
 	{
 		return std::find_if(str.begin(), str.end(), is_not_valid) == str.end();
 	}
+
 } // namespace Detail::algorithm
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -574,14 +565,15 @@ std::string LibCompiler::EncoderAMD64::CheckLine(std::string&		line,
 {
 	std::string err_str;
 
-	if (line.empty() || LibCompiler::find_word(line, "extern_segment") ||
-		LibCompiler::find_word(line, "public_segment") ||
-		LibCompiler::find_word(line, kAssemblerPragmaSymStr) ||
-		LibCompiler::find_word(line, ";") || line[0] == kAssemblerPragmaSym)
+	auto tokens = Detail::asm_lex_line(line, kAssemblerCommentSymStr, kAssemblerPragmaSym);
+
+	if (tokens.fMnemonic.empty() || tokens.fMnemonic == "extern_segment" ||
+		tokens.fMnemonic == "public_segment" || tokens.fPragma ||
+		!tokens.fComment.empty())
 	{
-		if (line.find(';') != std::string::npos)
+		if (!tokens.fComment.empty())
 		{
-			line.erase(line.find(';'));
+			line.erase(tokens.fComment.data() - line.data());
 		}
 		else
 		{
@@ -598,54 +590,11 @@ std::string LibCompiler::EncoderAMD64::CheckLine(std::string&		line,
 
 	// check for a valid instruction format.
 
-	if (line.find(',') != std::string::npos)
-	{
-		if (line.find(',') + 1 == line.size())
-		{
-			err_str += "\nInstruction lacks right register, here -> ";
-			err_str += line.substr(line.find(','));
-
-			return err_str;
-		}
-		else
-		{
-			bool nothing_on_right = true;
-
-			if (line.find(',') + 1 > line.size())
-			{
-				err_str += "\nInstruction not complete, here -> ";
-				err_str += line;
-
-				return err_str;
-			}
-
-			auto substr = line.substr(line.find(',') + 1);
-
-			for (auto& ch : substr)
-			{
-				if (ch != ' ' && ch != '\t')
-				{
-					nothing_on_right = false;
-				}
-			}
-
-			// this means we found nothing after that ',' .
-			if (nothing_on_right)
-			{
-				err_str += "\nInstruction not complete, here -> ";
-				err_str += line;
+	if (err_str = Detail::asm_check_operands(tokens, line); !err_str.empty())
+		return err_str;
 
-				return err_str;
-			}
-		}
-	}
-	for (auto& opcodeAMD64 : kOpcodesAMD64)
-	{
-		if (LibCompiler::find_word(line, opcodeAMD64.fName))
-		{
-			return err_str;
-		}
-	}
+	if (find_opcode_amd64(tokens.fMnemonic))
+		return err_str;
 
 	err_str += "\nUnrecognized instruction -> " + line;
 
@@ -674,13 +623,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber(const std::size_t& pos,
 		LibCompiler::NumberCast64 num = LibCompiler::NumberCast64(
 			strtol(jump_label.substr(pos + 2).c_str(), nullptr, 16));
 
-		for (char& i : num.number)
-		{
-			if (i == 0)
-				i = 0xFF;
-
-			kAppBytes.push_back(i);
-		}
+		kAppBytes.Append(num.number, sizeof(num.number));
 
 		if (kVerbose)
 		{
@@ -710,13 +653,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber(const std::size_t& pos,
 					<< jump_label.substr(pos) << "\n";
 		}
 
-		for (char& i : num.number)
-		{
-			if (i == 0)
-				i = 0xFF;
-
-			kAppBytes.push_back(i);
-		}
+		kAppBytes.Append(num.number, sizeof(num.number));
 
 		return true;
 	}
@@ -740,13 +677,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber(const std::size_t& pos,
 					<< jump_label.substr(pos) << "\n";
 		}
 
-		for (char& i : num.number)
-		{
-			if (i == 0)
-				i = 0xFF;
-
-			kAppBytes.push_back(i);
-		}
+		kAppBytes.Append(num.number, sizeof(num.number));
 
 		return true;
 	}
@@ -767,13 +698,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber(const std::size_t& pos,
 	LibCompiler::NumberCast64 num = LibCompiler::NumberCast64(
 		strtol(jump_label.substr(pos).c_str(), nullptr, 10));
 
-	for (char& i : num.number)
-	{
-		if (i == 0)
-			i = 0xFF;
-
-		kAppBytes.push_back(i);
-	}
+	kAppBytes.Append(num.number, sizeof(num.number));
 
 	if (kVerbose)
 	{
@@ -803,13 +728,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber32(const std::size_t& pos,
 
 		LibCompiler::NumberCast32 num = LibCompiler::NumberCast32(res);
 
-		for (char& i : num.number)
-		{
-			if (i == 0)
-				i = 0xFF;
-
-			kAppBytes.push_back(i);
-		}
+		kAppBytes.Append(num.number, sizeof(num.number));
 
 		if (kVerbose)
 		{
@@ -836,13 +755,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber32(const std::size_t& pos,
 					<< jump_label.substr(pos) << "\n";
 		}
 
-		for (char& i : num.number)
-		{
-			if (i == 0)
-				i = 0xFF;
-
-			kAppBytes.push_back(i);
-		}
+		kAppBytes.Append(num.number, sizeof(num.number));
 
 		return true;
 	}
@@ -863,13 +776,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber32(const std::size_t& pos,
 					<< jump_label.substr(pos) << "\n";
 		}
 
-		for (char& i : num.number)
-		{
-			if (i == 0)
-				i = 0xFF;
-
-			kAppBytes.push_back(i);
-		}
+		kAppBytes.Append(num.number, sizeof(num.number));
 
 		return true;
 	}
@@ -888,13 +795,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber32(const std::size_t& pos,
 
 	LibCompiler::NumberCast32 num = LibCompiler::NumberCast32(res);
 
-	for (char& i : num.number)
-	{
-		if (i == 0)
-			i = 0xFF;
-
-		kAppBytes.push_back(i);
-	}
+	kAppBytes.Append(num.number, sizeof(num.number));
 
 	if (kVerbose)
 	{
@@ -927,13 +828,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber16(const std::size_t& pos,
 		LibCompiler::NumberCast16 num = LibCompiler::NumberCast16(
 			strtol(jump_label.substr(pos + 2).c_str(), nullptr, 16));
 
-		for (char& i : num.number)
-		{
-			if (i == 0)
-				i = 0xFF;
-
-			kAppBytes.push_back(i);
-		}
+		kAppBytes.Append(num.number, sizeof(num.number));
 
 		if (kVerbose)
 		{
@@ -963,13 +858,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber16(const std::size_t& pos,
 					<< jump_label.substr(pos) << "\n";
 		}
 
-		for (char& i : num.number)
-		{
-			if (i == 0)
-				i = 0xFF;
-
-			kAppBytes.push_back(i);
-		}
+		kAppBytes.Append(num.number, sizeof(num.number));
 
 		return true;
 	}
@@ -993,13 +882,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber16(const std::size_t& pos,
 					<< jump_label.substr(pos) << "\n";
 		}
 
-		for (char& i : num.number)
-		{
-			if (i == 0)
-				i = 0xFF;
-
-			kAppBytes.push_back(i);
-		}
+		kAppBytes.Append(num.number, sizeof(num.number));
 
 		return true;
 	}
@@ -1020,13 +903,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber16(const std::size_t& pos,
 	LibCompiler::NumberCast16 num = LibCompiler::NumberCast16(
 		strtol(jump_label.substr(pos).c_str(), nullptr, 10));
 
-	for (char& i : num.number)
-	{
-		if (i == 0)
-			i = 0xFF;
-
-		kAppBytes.push_back(i);
-	}
+	kAppBytes.Append(num.number, sizeof(num.number));
 
 	if (kVerbose)
 	{
@@ -1059,7 +936,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber8(const std::size_t& pos,
 		LibCompiler::NumberCast8 num = LibCompiler::NumberCast8(
 			strtol(jump_label.substr(pos + 2).c_str(), nullptr, 16));
 
-		kAppBytes.push_back(num.number);
+		kAppBytes.Append(num.number);
 
 		if (kVerbose)
 		{
@@ -1089,7 +966,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber8(const std::size_t& pos,
 					<< jump_label.substr(pos) << "\n";
 		}
 
-		kAppBytes.push_back(num.number);
+		kAppBytes.Append(num.number);
 
 		return true;
 	}
@@ -1113,7 +990,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber8(const std::size_t& pos,
 					<< jump_label.substr(pos) << "\n";
 		}
 
-		kAppBytes.push_back(num.number);
+		kAppBytes.Append(num.number);
 
 		return true;
 	}
@@ -1134,7 +1011,7 @@ bool LibCompiler::EncoderAMD64::WriteNumber8(const std::size_t& pos,
 	LibCompiler::NumberCast8 num = LibCompiler::NumberCast8(
 		strtol(jump_label.substr(pos).c_str(), nullptr, 10));
 
-	kAppBytes.push_back(num.number);
+	kAppBytes.Append(num.number);
 
 	if (kVerbose)
 	{
@@ -1154,9 +1031,16 @@ bool LibCompiler::EncoderAMD64::WriteNumber8(const std::size_t& pos,
 bool LibCompiler::EncoderAMD64::WriteLine(std::string&		 line,
 										  const std::string& file)
 {
-	if (LibCompiler::find_word(line, "public_segment "))
+	auto tokens = Detail::asm_lex_line(line, kAssemblerCommentSymStr, kAssemblerPragmaSym);
+
+	if (tokens.fMnemonic == "public_segment")
 		return true;
 
+	/// the mov handler consumes the line, so keep what we need from the tokens.
+	const std::string mnemonic(tokens.fMnemonic);
+	const bool		  is_pragma	  = tokens.fPragma;
+	const std::size_t operand_pos = tokens.fOperandCount > 0 ? tokens.fOperands[0].data() - line.data() : line.size();
+
 	struct RegMapAMD64
 	{
 		std::string fName;
@@ -1181,145 +1065,135 @@ bool LibCompiler::EncoderAMD64::WriteLine(std::string&		 line,
 		{.fName = "r11", .fModRM = 14},
 	};
 
-	bool foundInstruction = false;
+	// strict check here
+	const CpuOpcodeAMD64* opcodeAMD64	   = find_opcode_amd64(mnemonic);
+	bool				  foundInstruction = opcodeAMD64 && Detail::algorithm::is_valid_amd64(line);
 
-	for (auto& opcodeAMD64 : kOpcodesAMD64)
+	if (foundInstruction)
 	{
-		// strict check here
-		if (LibCompiler::find_word(line, opcodeAMD64.fName) &&
-			Detail::algorithm::is_valid_amd64(line))
+		const std::string& name = mnemonic;
+
+		/// Move instruction handler.
+		if (line.find(name) != std::string::npos &&
+			name == "mov")
 		{
-			foundInstruction = true;
-			std::string name(opcodeAMD64.fName);
+			std::string substr = line.substr(line.find(name) + name.size());
+
+			uint64_t bits = kRegisterBitWidth;
 
-			/// Move instruction handler.
-			if (line.find(name) != std::string::npos &&
-				name == "mov")
+			if (substr.find(",") == std::string::npos)
 			{
-				std::string substr = line.substr(line.find(name) + name.size());
+				Detail::print_error("Syntax error: missing right operand.", "LibCompiler");
+				throw std::runtime_error("syntax_err");
+			}
 
-				uint64_t bits = kRegisterBitWidth;
+			bool onlyOneReg = true;
 
-				if (substr.find(",") == std::string::npos)
-				{
-					Detail::print_error("Syntax error: missing right operand.", "LibCompiler");
-					throw std::runtime_error("syntax_err");
-				}
-
-				bool onlyOneReg = true;
+			std::vector<RegMapAMD64> currentRegList;
 
-				std::vector<RegMapAMD64> currentRegList;
+			for (auto& reg : kRegisterList)
+			{
+				std::vector<char> regExt = {'e', 'r'};
 
-				for (auto& reg : kRegisterList)
+				for (auto& ext : regExt)
 				{
-					std::vector<char> regExt = {'e', 'r'};
+					std::string registerName;
 
-					for (auto& ext : regExt)
-					{
-						std::string registerName;
+					if (bits > 16)
+						registerName.push_back(ext);
 
-						if (bits > 16)
-							registerName.push_back(ext);
+					registerName += reg.fName;
 
-						registerName += reg.fName;
+					while (line.find(registerName) != std::string::npos)
+					{
+						line.erase(line.find(registerName), registerName.size());
 
-						while (line.find(registerName) != std::string::npos)
+						if (bits == 16)
 						{
-							line.erase(line.find(registerName), registerName.size());
-
-							if (bits == 16)
+							if (registerName[0] == 'r')
 							{
-								if (registerName[0] == 'r')
-								{
-									Detail::print_error(
-										"invalid size for register, current bit width is: " +
-											std::to_string(kRegisterBitWidth),
-										file);
-									throw std::runtime_error("invalid_reg_size");
-								}
+								Detail::print_error(
+									"invalid size for register, current bit width is: " +
+										std::to_string(kRegisterBitWidth),
+									file);
+								throw std::runtime_error("invalid_reg_size");
 							}
-
-							currentRegList.push_back(
-								{.fName = registerName, .fModRM = reg.fModRM});
 						}
+
+						currentRegList.push_back(
+							{.fName = registerName, .fModRM = reg.fModRM});
 					}
 				}
+			}
 
-				if (currentRegList.size() > 1)
-					onlyOneReg = false;
+			if (currentRegList.size() > 1)
+				onlyOneReg = false;
 
-				bool hasRBasedRegs = false;
+			bool hasRBasedRegs = false;
 
-				if (!onlyOneReg)
+			if (!onlyOneReg)
+			{
+				/// very tricky to understand.
+				/// but this checks for a r8 through r15 register.
+				if (currentRegList[0].fName[0] == 'r' ||
+					currentRegList[1].fName[0] == 'r')
 				{
-					/// very tricky to understand.
-					/// but this checks for a r8 through r15 register.
-					if (currentRegList[0].fName[0] == 'r' ||
-						currentRegList[1].fName[0] == 'r')
+					if (isdigit(currentRegList[0].fName[1]) &&
+						isdigit(currentRegList[1].fName[1]))
 					{
-						if (isdigit(currentRegList[0].fName[1]) &&
-							isdigit(currentRegList[1].fName[1]))
-						{
-							kAppBytes.emplace_back(0x4d);
-							hasRBasedRegs = true;
-						}
-						else if (isdigit(currentRegList[0].fName[1]) ||
-								 isdigit(currentRegList[1].fName[1]))
-						{
-							kAppBytes.emplace_back(0x4c);
-							hasRBasedRegs = true;
-						}
+						kAppBytes.Append(0x4d);
+						hasRBasedRegs = true;
 					}
-				}
-
-				if (bits == 64 || bits == 32)
-				{
-					if (!hasRBasedRegs && bits >= 32)
+					else if (isdigit(currentRegList[0].fName[1]) ||
+							 isdigit(currentRegList[1].fName[1]))
 					{
-						kAppBytes.emplace_back(opcodeAMD64.fOpcode);
+						kAppBytes.Append(0x4c);
+						hasRBasedRegs = true;
 					}
-
-					if (!onlyOneReg)
-						kAppBytes.emplace_back(0x89);
 				}
-				else if (bits == 16)
+			}
+
+			if (bits == 64 || bits == 32)
+			{
+				if (!hasRBasedRegs && bits >= 32)
 				{
-					if (hasRBasedRegs)
-					{
-						Detail::print_error(
-							"Invalid combination of operands and registers.", "LibCompiler");
-						throw std::runtime_error("comb_op_reg");
-					}
-					else
-					{
-						kAppBytes.emplace_back(0x66);
-						kAppBytes.emplace_back(0x89);
-					}
+					kAppBytes.Append(opcodeAMD64->fOpcode);
 				}
 
-				if (onlyOneReg)
+				if (!onlyOneReg)
+					kAppBytes.Append(0x89);
+			}
+			else if (bits == 16)
+			{
+				if (hasRBasedRegs)
 				{
-					auto num = GetNumber32(line, ",");
-
-					for (auto& num_idx : num.number)
-					{
-						if (num_idx == 0)
-							num_idx = 0xFF;
-					}
-
-					auto modrm = (0x3 << 6 |
-								  currentRegList[0].fModRM);
+					Detail::print_error(
+						"Invalid combination of operands and registers.", "LibCompiler");
+					throw std::runtime_error("comb_op_reg");
+				}
+				else
+				{
+					kAppBytes.Append(0x66);
+					kAppBytes.Append(0x89);
+				}
+			}
 
-					kAppBytes.emplace_back(0xC7); // prefixed before placing the modrm and then the number.
-					kAppBytes.emplace_back(modrm);
-					kAppBytes.emplace_back(num.number[0]);
-					kAppBytes.emplace_back(num.number[1]);
-					kAppBytes.emplace_back(num.number[2]);
-					kAppBytes.emplace_back(num.number[3]);
+			if (onlyOneReg)
+			{
+				auto num = GetNumber32(line, ",");
 
-					break;
-				}
+				auto modrm = (0x3 << 6 |
+							  currentRegList[0].fModRM);
 
+				kAppBytes.Append(0xC7); // prefixed before placing the modrm and then the number.
+				kAppBytes.Append(modrm);
+				kAppBytes.Append(num.number[0]);
+				kAppBytes.Append(num.number[1]);
+				kAppBytes.Append(num.number[2]);
+				kAppBytes.Append(num.number[3]);
+			}
+			else
+			{
 				if (currentRegList[1].fName[0] == 'r' &&
 					currentRegList[0].fName[0] == 'e')
 				{
@@ -1378,38 +1252,30 @@ bool LibCompiler::EncoderAMD64::WriteLine(std::string&		 line,
 				auto modrm = (0x3 << 6 | currentRegList[1].fModRM << 3 |
 							  currentRegList[0].fModRM);
 
-				kAppBytes.emplace_back(modrm);
-
-				break;
-			}
-			else if (name == "int" || name == "into" || name == "intd")
-			{
-				kAppBytes.emplace_back(opcodeAMD64.fOpcode);
-				this->WriteNumber8(line.find(name) + name.size() + 1, line);
-
-				break;
+				kAppBytes.Append(modrm);
 			}
-			else if (name == "jmp" || name == "call")
-			{
-				kAppBytes.emplace_back(opcodeAMD64.fOpcode);
-
-				if (!this->WriteNumber32(line.find(name) + name.size() + 1, line))
-				{
-					throw std::runtime_error("BUG: WriteNumber32");
-				}
+		}
+		else if (name == "int" || name == "into" || name == "intd")
+		{
+			kAppBytes.Append(opcodeAMD64->fOpcode);
+			this->WriteNumber8(operand_pos, line);
+		}
+		else if (name == "jmp" || name == "call")
+		{
+			kAppBytes.Append(opcodeAMD64->fOpcode);
 
-				break;
-			}
-			else
+			if (!this->WriteNumber32(operand_pos, line))
 			{
-				kAppBytes.emplace_back(opcodeAMD64.fOpcode);
-
-				break;
+				throw std::runtime_error("BUG: WriteNumber32");
 			}
 		}
+		else
+		{
+			kAppBytes.Append(opcodeAMD64->fOpcode);
+		}
 	}
 
-	if (line[0] == kAssemblerPragmaSym)
+	if (is_pragma)
 	{
 		if (foundInstruction)
 		{
@@ -1458,19 +1324,19 @@ bool LibCompiler::EncoderAMD64::WriteLine(std::string&		 line,
 		}
 	}
 	/// write a dword
-	else if (line.find(".dword") != std::string::npos)
+	else if (mnemonic == ".dword")
 	{
-		this->WriteNumber32(line.find(".dword") + strlen(".dword") + 1, line);
+		this->WriteNumber32(operand_pos, line);
 	}
 	/// write a long
-	else if (line.find(".long") != std::string::npos)
+	else if (mnemonic == ".long")
 	{
-		this->WriteNumber(line.find(".long") + strlen(".long") + 1, line);
+		this->WriteNumber(operand_pos, line);
 	}
 	/// write a 16-bit number
-	else if (line.find(".word") != std::string::npos)
+	else if (mnemonic == ".word")
 	{
-		this->WriteNumber16(line.find(".word") + strlen(".word") + 1, line);
+		this->WriteNumber16(operand_pos, line);
 	}
 
 	kOrigin += kIPAlignement;
@@ -22,6 +22,7 @@
 #include <LibCompiler/PEF.h>
 #include <LibCompiler/Parser.h>
 #include <LibCompiler/AE.h>
+#include <AsmIO.h>
 #include <LibCompiler/Version.h>
 #include <filesystem>
 #include <algorithm>
@@ -58,7 +59,8 @@ static std::vector<std::pair<std::string, std::uintptr_t>> kOriginLabel;
 
 static bool kVerbose = false;
 
-static std::vector<uint8_t> kBytes;
+static Detail::AsmSectionBuffer kBytes;
+static std::vector<Detail::AsmSectionBuffer> kSections;
 
 static LibCompiler::AERecordHeader kCurrentRecord{
 	.fName = "", .fKind = LibCompiler::kPefCode, .fSize = 0, .fOffset = 0};
@@ -137,27 +139,30 @@ LIBCOMPILER_MODULE(AssemblerMainARM64)
 
 		object_output += kOutputAsBinary ? kBinaryFileExt : kObjectFileExt;
 
-		std::ifstream file_ptr(argv[i]);
-		std::ofstream file_ptr_out(object_output, std::ofstream::binary);
+		Detail::AsmSourceFile  asm_source(argv[i]);
+		Detail::AsmObjectImage obj_image;
 
-		if (file_ptr_out.bad())
+		if (!asm_source.IsOpen())
 		{
 			if (kVerbose)
 			{
-				kStdOut << "AssemblerPower: error: " << strerror(errno) << "\n";
+				kStdOut << "AssemblerARM64: error: " << strerror(errno) << "\n";
 			}
+
+			goto asm_fail_exit;
 		}
 
 		std::string line;
 
 		LibCompiler::AEHeader hdr{0};
 
-		memset(hdr.fPad, kAENullType, kAEPad);
+		memset(hdr.fPad, kAENullType, sizeof(hdr.fPad));
 
 		hdr.fMagic[0] = kAEMag0;
 		hdr.fMagic[1] = kAEMag1;
 		hdr.fSize	  = sizeof(LibCompiler::AEHeader);
 		hdr.fArch	  = kOutputArch;
+		hdr.fVersion  = kAEVersion;
 
 		/////////////////////////////////////////////////////////////////////////////////////////
 
@@ -167,8 +172,12 @@ LIBCOMPILER_MODULE(AssemblerMainARM64)
 
 		LibCompiler::EncoderARM64 asm64;
 
-		while (std::getline(file_ptr, line))
+		std::string_view line_view;
+
+		while (asm_source.ReadLine(line_view))
 		{
+			line.assign(line_view);
+
 			if (auto ln = asm64.CheckLine(line, argv[i]); !ln.empty())
 			{
 				Detail::print_error(ln, argv[i]);
@@ -193,6 +202,12 @@ LIBCOMPILER_MODULE(AssemblerMainARM64)
 			}
 		}
 
+		Detail::asm_close_sections(kRecords, kSections, kBytes);
+
+		obj_image.Reserve(sizeof(LibCompiler::AEHeader) +
+						  (kRecords.size() + kUndefinedSymbols.size()) * sizeof(LibCompiler::AERecordHeader) +
+						  Detail::asm_file_size(kSections));
+
 		if (!kOutputAsBinary)
 		{
 			if (kVerbose)
@@ -202,12 +217,6 @@ LIBCOMPILER_MODULE(AssemblerMainARM64)
 
 			// this is the final step, write everything to the file.
 
-			auto pos = file_ptr_out.tellp();
-
-			hdr.fCount = kRecords.size() + kUndefinedSymbols.size();
-
-			file_ptr_out << hdr;
-
 			if (kRecords.empty())
 			{
 				kStdErr << "AssemblerARM64: At least one record is needed to write an object "
@@ -217,7 +226,8 @@ LIBCOMPILER_MODULE(AssemblerMainARM64)
 				return 1;
 			}
 
-			kRecords[kRecords.size() - 1].fSize = kBytes.size();
+			// names go to the string table, the header is written once every record is in it.
+			Detail::AsmRecordTable record_table;
 
 			std::size_t record_count = 0UL;
 
@@ -227,7 +237,7 @@ LIBCOMPILER_MODULE(AssemblerMainARM64)
 				record_hdr.fOffset = record_count;
 				++record_count;
 
-				file_ptr_out << record_hdr;
+				record_table.Add(record_hdr);
 
 				if (kVerbose)
 					kStdOut << "AssemblerARM64: Wrote record " << record_hdr.fName << "...\n";
@@ -250,23 +260,17 @@ LIBCOMPILER_MODULE(AssemblerMainARM64)
 				++record_count;
 
 				memset(undefined_sym.fPad, kAENullType, kAEPad);
-				memcpy(undefined_sym.fName, sym.c_str(), sym.size());
 
-				file_ptr_out << undefined_sym;
+				record_table.Add(undefined_sym, sym);
 
 				++kCounter;
 			}
 
-			auto pos_end = file_ptr_out.tellp();
-
-			file_ptr_out.seekp(pos);
-
-			hdr.fStartCode = pos_end;
-			hdr.fCodeSize  = kBytes.size();
+			hdr.fCount	   = record_table.Count();
+			hdr.fStartCode = sizeof(LibCompiler::AEHeader) + record_table.Size();
+			hdr.fCodeSize  = Detail::asm_file_size(kSections);
 
-			file_ptr_out << hdr;
-
-			file_ptr_out.seekp(pos_end);
+			obj_image << hdr << record_table;
 		}
 		else
 		{
@@ -276,18 +280,18 @@ LIBCOMPILER_MODULE(AssemblerMainARM64)
 			}
 		}
 
-		// byte from byte, we write this.
-		for (auto& byte : kBytes)
+		for (auto& section : kSections)
+			obj_image << section;
+
+		if (!obj_image.Flush(object_output))
 		{
-			file_ptr_out.write(reinterpret_cast<const char*>(&byte), sizeof(byte));
+			kStdErr << "AssemblerARM64: can't write: " << object_output << "\n";
+			goto asm_fail_exit;
 		}
 
 		if (kVerbose)
 			kStdOut << "AssemblerARM64: Wrote file with program in it.\n";
 
-		file_ptr_out.flush();
-		file_ptr_out.close();
-
 		if (kVerbose)
 			kStdOut << "AssemblerARM64: Exit succeeded.\n";
 
@@ -311,9 +315,11 @@ asm_fail_exit:
 
 static bool asm_read_attributes(std::string& line)
 {
+	auto tokens = Detail::asm_lex_line(line, kAsmCommentSyms);
+
 	// extern_segment is the opposite of public_segment, it signals to the li
 	// that we need this symbol.
-	if (LibCompiler::find_word(line, "extern_segment"))
+	if (tokens.fMnemonic == "extern_segment")
 	{
 		if (kOutputAsBinary)
 		{
@@ -368,8 +374,7 @@ static bool asm_read_attributes(std::string& line)
 
 		// now we can tell the code size of the previous kCurrentRecord.
 
-		if (!kRecords.empty())
-			kRecords[kRecords.size() - 1].fSize = kBytes.size();
+		Detail::asm_open_section(kRecords, kSections, kBytes, kCurrentRecord.fKind);
 
 		memset(kCurrentRecord.fName, 0, kAESymbolLen);
 		memcpy(kCurrentRecord.fName, result.c_str(), result.size());
@@ -385,7 +390,7 @@ static bool asm_read_attributes(std::string& line)
 	// public_segment is a special keyword used by Assembler to tell the AE output stage to
 	// mark this section as a header. it currently supports .code64, .data64.,
 	// .zero64
-	else if (LibCompiler::find_word(line, "public_segment"))
+	else if (tokens.fMnemonic == "public_segment")
 	{
 		if (kOutputAsBinary)
 		{
@@ -442,8 +447,7 @@ static bool asm_read_attributes(std::string& line)
 
 		// now we can tell the code size of the previous kCurrentRecord.
 
-		if (!kRecords.empty())
-			kRecords[kRecords.size() - 1].fSize = kBytes.size();
+		Detail::asm_open_section(kRecords, kSections, kBytes, kCurrentRecord.fKind);
 
 		memset(kCurrentRecord.fName, 0, kAESymbolLen);
 		memcpy(kCurrentRecord.fName, name.c_str(), name.size());
@@ -490,17 +494,14 @@ std::string LibCompiler::EncoderARM64::CheckLine(std::string&		line,
 {
 	std::string err_str;
 
-	if (line.empty() || LibCompiler::find_word(line, "extern_segment") ||
-		LibCompiler::find_word(line, "public_segment") ||
-		line.find('#') != std::string::npos || LibCompiler::find_word(line, ";"))
+	auto tokens = Detail::asm_lex_line(line, kAsmCommentSyms);
+
+	if (tokens.fMnemonic.empty() || tokens.fMnemonic == "extern_segment" ||
+		tokens.fMnemonic == "public_segment" || !tokens.fComment.empty())
 	{
-		if (line.find('#') != std::string::npos)
+		if (!tokens.fComment.empty())
 		{
-			line.erase(line.find('#'));
-		}
-		else if (line.find(';') != std::string::npos)
-		{
-			line.erase(line.find(';'));
+			line.erase(tokens.fComment.data() - line.data());
 		}
 		else
 		{
@@ -525,49 +526,7 @@ std::string LibCompiler::EncoderARM64::CheckLine(std::string&		line,
 
 	// check for a valid instruction format.
 
-	if (line.find(',') != std::string::npos)
-	{
-		if (line.find(',') + 1 == line.size())
-		{
-			err_str += "\nInstruction lacks right register, here -> ";
-			err_str += line.substr(line.find(','));
-
-			return err_str;
-		}
-		else
-		{
-			bool nothing_on_right = true;
-
-			if (line.find(',') + 1 > line.size())
-			{
-				err_str += "\nInstruction not complete, here -> ";
-				err_str += line;
-
-				return err_str;
-			}
-
-			auto substr = line.substr(line.find(',') + 1);
-
-			for (auto& ch : substr)
-			{
-				if (ch != ' ' && ch != '\t')
-				{
-					nothing_on_right = false;
-				}
-			}
-
-			// this means we found nothing after that ',' .
-			if (nothing_on_right)
-			{
-				err_str += "\nInstruction not complete, here -> ";
-				err_str += line;
-
-				return err_str;
-			}
-		}
-	}
-
-	return err_str;
+	return Detail::asm_check_operands(tokens, line);
 }
 
 bool LibCompiler::EncoderARM64::WriteNumber(const std::size_t& pos,
@@ -594,7 +553,7 @@ bool LibCompiler::EncoderARM64::WriteNumber(const std::size_t& pos,
 
 		for (char& i : num.number)
 		{
-			kBytes.push_back(i);
+			kBytes.Append(i);
 		}
 
 		if (kVerbose)
@@ -627,7 +586,7 @@ bool LibCompiler::EncoderARM64::WriteNumber(const std::size_t& pos,
 
 		for (char& i : num.number)
 		{
-			kBytes.push_back(i);
+			kBytes.Append(i);
 		}
 
 		return true;
@@ -654,7 +613,7 @@ bool LibCompiler::EncoderARM64::WriteNumber(const std::size_t& pos,
 
 		for (char& i : num.number)
 		{
-			kBytes.push_back(i);
+			kBytes.Append(i);
 		}
 
 		return true;
@@ -678,7 +637,7 @@ bool LibCompiler::EncoderARM64::WriteNumber(const std::size_t& pos,
 
 	for (char& i : num.number)
 	{
-		kBytes.push_back(i);
+		kBytes.Append(i);
 	}
 
 	if (kVerbose)
@@ -699,7 +658,7 @@ bool LibCompiler::EncoderARM64::WriteNumber(const std::size_t& pos,
 bool LibCompiler::EncoderARM64::WriteLine(std::string&		 line,
 										  const std::string& file)
 {
-	if (LibCompiler::find_word(line, "public_segment"))
+	if (Detail::asm_lex_line(line, kAsmCommentSyms).fMnemonic == "public_segment")
 		return false;
 
 	if (!Detail::algorithm::is_valid_arm64(line))
@@ -22,6 +22,7 @@
 #include <LibCompiler/PEF.h>
 #include <LibCompiler/Parser.h>
 #include <LibCompiler/AE.h>
+#include <AsmIO.h>
 #include <LibCompiler/Version.h>
 #include <filesystem>
 #include <algorithm>
@@ -58,7 +59,8 @@ static std::vector<std::pair<std::string, std::uintptr_t>> kOriginLabel;
 
 static bool kVerbose = false;
 
-static std::vector<uint8_t> kBytes;
+static Detail::AsmSectionBuffer kBytes;
+static std::vector<Detail::AsmSectionBuffer> kSections;
 
 static LibCompiler::AERecordHeader kCurrentRecord{
 	.fName = "", .fKind = LibCompiler::kPefCode, .fSize = 0, .fOffset = 0};
@@ -137,27 +139,30 @@ LIBCOMPILER_MODULE(AssemblerMainPower64)
 
 		object_output += kOutputAsBinary ? kBinaryFileExt : kObjectFileExt;
 
-		std::ifstream file_ptr(argv[i]);
-		std::ofstream file_ptr_out(object_output, std::ofstream::binary);
+		Detail::AsmSourceFile  asm_source(argv[i]);
+		Detail::AsmObjectImage obj_image;
 
-		if (file_ptr_out.bad())
+		if (!asm_source.IsOpen())
 		{
 			if (kVerbose)
 			{
 				kStdOut << "AssemblerPower: error: " << strerror(errno) << "\n";
 			}
+
+			goto asm_fail_exit;
 		}
 
 		std::string line;
 
 		LibCompiler::AEHeader hdr{0};
 
-		memset(hdr.fPad, kAENullType, kAEPad);
+		memset(hdr.fPad, kAENullType, sizeof(hdr.fPad));
 
 		hdr.fMagic[0] = kAEMag0;
 		hdr.fMagic[1] = kAEMag1;
 		hdr.fSize	  = sizeof(LibCompiler::AEHeader);
 		hdr.fArch	  = kOutputArch;
+		hdr.fVersion  = kAEVersion;
 
 		/////////////////////////////////////////////////////////////////////////////////////////
 
@@ -167,8 +172,12 @@ LIBCOMPILER_MODULE(AssemblerMainPower64)
 
 		LibCompiler::EncoderPowerPC asm64;
 
-		while (std::getline(file_ptr, line))
+		std::string_view line_view;
+
+		while (asm_source.ReadLine(line_view))
 		{
+			line.assign(line_view);
+
 			if (auto ln = asm64.CheckLine(line, argv[i]); !ln.empty())
 			{
 				Detail::print_error(ln, argv[i]);
@@ -193,6 +202,12 @@ LIBCOMPILER_MODULE(AssemblerMainPower64)
 			}
 		}
 
+		Detail::asm_close_sections(kRecords, kSections, kBytes);
+
+		obj_image.Reserve(sizeof(LibCompiler::AEHeader) +
+						  (kRecords.size() + kUndefinedSymbols.size()) * sizeof(LibCompiler::AERecordHeader) +
+						  Detail::asm_file_size(kSections));
+
 		if (!kOutputAsBinary)
 		{
 			if (kVerbose)
@@ -202,12 +217,6 @@ LIBCOMPILER_MODULE(AssemblerMainPower64)
 
 			// this is the final step, write everything to the file.
 
-			auto pos = file_ptr_out.tellp();
-
-			hdr.fCount = kRecords.size() + kUndefinedSymbols.size();
-
-			file_ptr_out << hdr;
-
 			if (kRecords.empty())
 			{
 				kStdErr << "AssemblerPower: At least one record is needed to write an object "
@@ -217,7 +226,8 @@ LIBCOMPILER_MODULE(AssemblerMainPower64)
 				return 1;
 			}
 
-			kRecords[kRecords.size() - 1].fSize = kBytes.size();
+			// names go to the string table, the header is written once every record is in it.
+			Detail::AsmRecordTable record_table;
 
 			std::size_t record_count = 0UL;
 
@@ -227,7 +237,7 @@ LIBCOMPILER_MODULE(AssemblerMainPower64)
 				record_hdr.fOffset = record_count;
 				++record_count;
 
-				file_ptr_out << record_hdr;
+				record_table.Add(record_hdr);
 
 				if (kVerbose)
 					kStdOut << "AssemblerPower: Wrote record " << record_hdr.fName << "...\n";
@@ -250,23 +260,17 @@ LIBCOMPILER_MODULE(AssemblerMainPower64)
 				++record_count;
 
 				memset(undefined_sym.fPad, kAENullType, kAEPad);
-				memcpy(undefined_sym.fName, sym.c_str(), sym.size());
 
-				file_ptr_out << undefined_sym;
+				record_table.Add(undefined_sym, sym);
 
 				++kCounter;
 			}
 
-			auto pos_end = file_ptr_out.tellp();
-
-			file_ptr_out.seekp(pos);
-
-			hdr.fStartCode = pos_end;
-			hdr.fCodeSize  = kBytes.size();
+			hdr.fCount	   = record_table.Count();
+			hdr.fStartCode = sizeof(LibCompiler::AEHeader) + record_table.Size();
+			hdr.fCodeSize  = Detail::asm_file_size(kSections);
 
-			file_ptr_out << hdr;
-
-			file_ptr_out.seekp(pos_end);
+			obj_image << hdr << record_table;
 		}
 		else
 		{
@@ -276,18 +280,18 @@ LIBCOMPILER_MODULE(AssemblerMainPower64)
 			}
 		}
 
-		// byte from byte, we write this.
-		for (auto& byte : kBytes)
+		for (auto& section : kSections)
+			obj_image << section;
+
+		if (!obj_image.Flush(object_output))
 		{
-			file_ptr_out.write(reinterpret_cast<const char*>(&byte), sizeof(byte));
+			kStdErr << "AssemblerPower: can't write: " << object_output << "\n";
+			goto asm_fail_exit;
 		}
 
 		if (kVerbose)
 			kStdOut << "AssemblerPower: Wrote file with program in it.\n";
 
-		file_ptr_out.flush();
-		file_ptr_out.close();
-
 		if (kVerbose)
 			kStdOut << "AssemblerPower: Exit succeeded.\n";
 
@@ -311,9 +315,11 @@ asm_fail_exit:
 
 static bool asm_read_attributes(std::string& line)
 {
+	auto tokens = Detail::asm_lex_line(line, kAsmCommentSyms);
+
 	// extern_segment is the opposite of public_segment, it signals to the li
 	// that we need this symbol.
-	if (LibCompiler::find_word(line, "extern_segment"))
+	if (tokens.fMnemonic == "extern_segment")
 	{
 		if (kOutputAsBinary)
 		{
@@ -368,8 +374,7 @@ static bool asm_read_attributes(std::string& line)
 
 		// now we can tell the code size of the previous kCurrentRecord.
 
-		if (!kRecords.empty())
-			kRecords[kRecords.size() - 1].fSize = kBytes.size();
+		Detail::asm_open_section(kRecords, kSections, kBytes, kCurrentRecord.fKind);
 
 		memset(kCurrentRecord.fName, 0, kAESymbolLen);
 		memcpy(kCurrentRecord.fName, result.c_str(), result.size());
@@ -385,7 +390,7 @@ static bool asm_read_attributes(std::string& line)
 	// public_segment is a special keyword used by AssemblerPower to tell the AE output stage to
 	// mark this section as a header. it currently supports .code64, .data64.,
 	// .zero64
-	else if (LibCompiler::find_word(line, "public_segment"))
+	else if (tokens.fMnemonic == "public_segment")
 	{
 		if (kOutputAsBinary)
 		{
@@ -442,8 +447,7 @@ static bool asm_read_attributes(std::string& line)
 
 		// now we can tell the code size of the previous kCurrentRecord.
 
-		if (!kRecords.empty())
-			kRecords[kRecords.size() - 1].fSize = kBytes.size();
+		Detail::asm_open_section(kRecords, kSections, kBytes, kCurrentRecord.fKind);
 
 		memset(kCurrentRecord.fName, 0, kAESymbolLen);
 		memcpy(kCurrentRecord.fName, name.c_str(), name.size());
@@ -477,6 +481,21 @@ namespace Detail::algorithm
 	{
 		return std::find_if(str.begin(), str.end(), is_not_alnum_space) == str.end();
 	}
+
+	// \brief the register of an operand, rN, rN+offset or offset(rN), empty if it has none.
+	static inline std::string_view register_of_power64(std::string_view operand)
+	{
+		if (auto open = operand.find('('); open != std::string_view::npos && operand.ends_with(')'))
+			operand = operand.substr(open + 1, operand.size() - open - 2);
+
+		operand = operand.substr(0, operand.find('+'));
+
+		if (operand.size() <= strlen(kAsmRegisterPrefix) || !operand.starts_with(kAsmRegisterPrefix) ||
+			!std::all_of(operand.begin() + strlen(kAsmRegisterPrefix), operand.end(), [](char c) { return isdigit(c) != 0; }))
+			return {};
+
+		return operand;
+	}
 } // namespace Detail::algorithm
 
 /////////////////////////////////////////////////////////////////////////////////////////
@@ -490,17 +509,14 @@ std::string LibCompiler::EncoderPowerPC::CheckLine(std::string&		  line,
 {
 	std::string err_str;
 
-	if (line.empty() || LibCompiler::find_word(line, "extern_segment") ||
-		LibCompiler::find_word(line, "public_segment") ||
-		line.find('#') != std::string::npos || LibCompiler::find_word(line, ";"))
+	auto tokens = Detail::asm_lex_line(line, kAsmCommentSyms);
+
+	if (tokens.fMnemonic.empty() || tokens.fMnemonic == "extern_segment" ||
+		tokens.fMnemonic == "public_segment" || !tokens.fComment.empty())
 	{
-		if (line.find('#') != std::string::npos)
-		{
-			line.erase(line.find('#'));
-		}
-		else if (line.find(';') != std::string::npos)
+		if (!tokens.fComment.empty())
 		{
-			line.erase(line.find(';'));
+			line.erase(tokens.fComment.data() - line.data());
 		}
 		else
 		{
@@ -525,90 +541,27 @@ std::string LibCompiler::EncoderPowerPC::CheckLine(std::string&		  line,
 
 	// check for a valid instruction format.
 
-	if (line.find(',') != std::string::npos)
-	{
-		if (line.find(',') + 1 == line.size())
-		{
-			err_str += "\nInstruction lacks right register, here -> ";
-			err_str += line.substr(line.find(','));
-
-			return err_str;
-		}
-		else
-		{
-			bool nothing_on_right = true;
-
-			if (line.find(',') + 1 > line.size())
-			{
-				err_str += "\nInstruction not complete, here -> ";
-				err_str += line;
-
-				return err_str;
-			}
-
-			auto substr = line.substr(line.find(',') + 1);
-
-			for (auto& ch : substr)
-			{
-				if (ch != ' ' && ch != '\t')
-				{
-					nothing_on_right = false;
-				}
-			}
-
-			// this means we found nothing after that ',' .
-			if (nothing_on_right)
-			{
-				err_str += "\nInstruction not complete, here -> ";
-				err_str += line;
-
-				return err_str;
-			}
-		}
-	}
+	if (err_str = Detail::asm_check_operands(tokens, line); !err_str.empty())
+		return err_str;
 
 	// these do take an argument.
 	std::vector<std::string> operands_inst = {"stw", "li"};
 
-	// these don't.
-	std::vector<std::string> filter_inst = {"blr", "bl", "sc"};
-
-	for (auto& opcode_risc : kOpcodesPowerPC)
+	if (find_opcode_power64(tokens.fMnemonic))
 	{
-		if (LibCompiler::find_word(line, opcode_risc.name))
+		for (auto& op : operands_inst)
 		{
-			for (auto& op : operands_inst)
-			{
-				// if only the instruction was found.
-				if (line == op)
-				{
-					err_str += "\nMalformed ";
-					err_str += op;
-					err_str += " instruction, here -> ";
-					err_str += line;
-				}
-			}
-
-			// if it is like that -> addr1, 0x0
-			if (auto it =
-					std::find(filter_inst.begin(), filter_inst.end(), opcode_risc.name);
-				it == filter_inst.cend())
+			// if only the instruction was found.
+			if (tokens.fMnemonic == op && tokens.fOperandCount == 0)
 			{
-				if (LibCompiler::find_word(line, opcode_risc.name))
-				{
-					if (!isspace(
-							line[line.find(opcode_risc.name) + strlen(opcode_risc.name)]))
-					{
-						err_str += "\nMissing space between ";
-						err_str += opcode_risc.name;
-						err_str += " and operands.\nhere -> ";
-						err_str += line;
-					}
-				}
+				err_str += "\nMalformed ";
+				err_str += op;
+				err_str += " instruction, here -> ";
+				err_str += line;
 			}
-
-			return err_str;
 		}
+
+		return err_str;
 	}
 
 	err_str += "Unrecognized instruction: " + line;
@@ -640,7 +593,7 @@ bool LibCompiler::EncoderPowerPC::WriteNumber(const std::size_t& pos,
 
 		for (char& i : num.number)
 		{
-			kBytes.push_back(i);
+			kBytes.Append(i);
 		}
 
 		if (kVerbose)
@@ -673,7 +626,7 @@ bool LibCompiler::EncoderPowerPC::WriteNumber(const std::size_t& pos,
 
 		for (char& i : num.number)
 		{
-			kBytes.push_back(i);
+			kBytes.Append(i);
 		}
 
 		return true;
@@ -700,7 +653,7 @@ bool LibCompiler::EncoderPowerPC::WriteNumber(const std::size_t& pos,
 
 		for (char& i : num.number)
 		{
-			kBytes.push_back(i);
+			kBytes.Append(i);
 		}
 
 		return true;
@@ -724,7 +677,7 @@ bool LibCompiler::EncoderPowerPC::WriteNumber(const std::size_t& pos,
 
 	for (char& i : num.number)
 	{
-		kBytes.push_back(i);
+		kBytes.Append(i);
 	}
 
 	if (kVerbose)
@@ -745,350 +698,344 @@ bool LibCompiler::EncoderPowerPC::WriteNumber(const std::size_t& pos,
 bool LibCompiler::EncoderPowerPC::WriteLine(std::string&	   line,
 											const std::string& file)
 {
-	if (LibCompiler::find_word(line, "public_segment"))
+	auto tokens = Detail::asm_lex_line(line, kAsmCommentSyms);
+
+	if (tokens.fMnemonic == "public_segment")
 		return false;
 	if (!Detail::algorithm::is_valid_power64(line))
 		return false;
 
-	for (auto& opcode_risc : kOpcodesPowerPC)
+	auto opcode_risc = find_opcode_power64(tokens.fMnemonic);
+
+	// strict check here
+	if (!opcode_risc)
+		return true;
+
+	std::string			name(opcode_risc->name);
+	std::string			jump_label, cpy_jump_label;
+	std::vector<size_t> found_registers_index;
+
+	// check funct7 type.
+	switch (opcode_risc->ops->type)
 	{
-		// strict check here
-		if (LibCompiler::find_word(line, opcode_risc.name))
+	default: {
+		NumberCast32 num(opcode_risc->opcode);
+
+		for (auto ch : num.number)
+		{
+			kBytes.Append(ch);
+		}
+		break;
+	}
+	case BADDR:
+	case PCREL: {
+		auto num = GetNumber32(tokens.fOperandCount > 0 ? std::string(tokens.fOperands[0]) : "0", "");
+
+		kBytes.Append(num.number[0]);
+		kBytes.Append(num.number[1]);
+		kBytes.Append(num.number[2]);
+		kBytes.Append(0x48);
+
+		break;
+	}
+	/// General purpose, float, vector operations. Everything that involve
+	/// registers.
+	case G0REG:
+	case FREG:
+	case VREG:
+	case GREG: {
+		// \brief how many registers we found.
+		std::size_t found_some_count = 0UL;
+		std::size_t register_count	 = 0UL;
+		std::string opcodeName		 = opcode_risc->name;
+		std::size_t register_sum	 = 0;
+
+		NumberCast64 num(opcode_risc->opcode);
+
+		for (std::size_t operand_index = 0UL; operand_index < tokens.fOperandCount; ++operand_index)
 		{
-			std::string			name(opcode_risc.name);
-			std::string			jump_label, cpy_jump_label;
-			std::vector<size_t> found_registers_index;
+			auto register_syntax = Detail::algorithm::register_of_power64(tokens.fOperands[operand_index]);
+
+			if (register_syntax.empty())
+				continue;
+
+			std::string reg_str(register_syntax.substr(strlen(kAsmRegisterPrefix)));
 
-			// check funct7 type.
-			switch (opcode_risc.ops->type)
+			// it ranges from r0 to r19
+			// something like r190 doesn't exist in the instruction set.
+			if (reg_str.size() > 2)
 			{
-			default: {
-				NumberCast32 num(opcode_risc.opcode);
+				Detail::print_error(
+					"invalid register index, r" + reg_str +
+						"\nnote: The POWER accepts registers from r0 to r32.",
+					file);
+				throw std::runtime_error("invalid_register_index");
+			}
 
-				for (auto ch : num.number)
+			// finally cast to a size_t
+			std::size_t reg_index = strtol(reg_str.c_str(), nullptr, 10);
+
+			if (reg_index > kAsmRegisterLimit)
+			{
+				Detail::print_error("invalid register index, r" + reg_str,
+									file);
+				throw std::runtime_error("invalid_register_index");
+			}
+
+			if (opcodeName == "li")
+			{
+				char numIndex = 0;
+
+				for (size_t i = 0; i != reg_index; i++)
 				{
-					kBytes.emplace_back(ch);
+					numIndex += 0x20;
 				}
-				break;
-			}
-			case BADDR:
-			case PCREL: {
-				auto num = GetNumber32(line, name);
 
-				kBytes.emplace_back(num.number[0]);
-				kBytes.emplace_back(num.number[1]);
-				kBytes.emplace_back(num.number[2]);
-				kBytes.emplace_back(0x48);
+				// the immediate follows the register.
+				auto num = GetNumber32(operand_index + 1 < tokens.fOperandCount ? std::string(tokens.fOperands[operand_index + 1]) : "0", "");
+
+				kBytes.Append(num.number[0]);
+				kBytes.Append(num.number[1]);
+				kBytes.Append(numIndex);
+				kBytes.Append(0x38);
+
+				// check if bigger than two.
+				for (size_t i = 2; i < 4; i++)
+				{
+					if (num.number[i] > 0)
+					{
+						Detail::print_warning("number overflow on li operation.",
+											  file);
+						break;
+					}
+				}
 
 				break;
 			}
-			/// General purpose, float, vector operations. Everything that involve
-			/// registers.
-			case G0REG:
-			case FREG:
-			case VREG:
-			case GREG: {
-				// \brief how many registers we found.
-				std::size_t found_some_count = 0UL;
-				std::size_t register_count	 = 0UL;
-				std::string opcodeName		 = opcode_risc.name;
-				std::size_t register_sum	 = 0;
-
-				NumberCast64 num(opcode_risc.opcode);
-
-				for (size_t line_index = 0UL; line_index < line.size();
-					 line_index++)
+
+			if ((opcodeName[0] == 's' && opcodeName[1] == 't'))
+			{
+				if (register_sum == 0)
 				{
-					if (line[line_index] == kAsmRegisterPrefix[0] &&
-						isdigit(line[line_index + 1]))
+					for (size_t indexReg = 0UL; indexReg < reg_index;
+						 ++indexReg)
 					{
-						std::string register_syntax = kAsmRegisterPrefix;
-						register_syntax += line[line_index + 1];
-
-						if (isdigit(line[line_index + 2]))
-							register_syntax += line[line_index + 2];
-
-						std::string reg_str;
-						reg_str += line[line_index + 1];
-
-						if (isdigit(line[line_index + 2]))
-							reg_str += line[line_index + 2];
-
-						// it ranges from r0 to r19
-						// something like r190 doesn't exist in the instruction set.
-						if (isdigit(line[line_index + 3]) &&
-							isdigit(line[line_index + 2]))
-						{
-							reg_str += line[line_index + 3];
-							Detail::print_error(
-								"invalid register index, r" + reg_str +
-									"\nnote: The POWER accepts registers from r0 to r32.",
-								file);
-							throw std::runtime_error("invalid_register_index");
-						}
-
-						// finally cast to a size_t
-						std::size_t reg_index = strtol(reg_str.c_str(), nullptr, 10);
-
-						if (reg_index > kAsmRegisterLimit)
-						{
-							Detail::print_error("invalid register index, r" + reg_str,
-												file);
-							throw std::runtime_error("invalid_register_index");
-						}
-
-						if (opcodeName == "li")
-						{
-							char numIndex = 0;
-
-							for (size_t i = 0; i != reg_index; i++)
-							{
-								numIndex += 0x20;
-							}
-
-							auto num = GetNumber32(line, reg_str);
-
-							kBytes.push_back(num.number[0]);
-							kBytes.push_back(num.number[1]);
-							kBytes.push_back(numIndex);
-							kBytes.push_back(0x38);
-
-							// check if bigger than two.
-							for (size_t i = 2; i < 4; i++)
-							{
-								if (num.number[i] > 0)
-								{
-									Detail::print_warning("number overflow on li operation.",
-														  file);
-									break;
-								}
-							}
-
-							break;
-						}
-
-						if ((opcodeName[0] == 's' && opcodeName[1] == 't'))
-						{
-							if (register_sum == 0)
-							{
-								for (size_t indexReg = 0UL; indexReg < reg_index;
-									 ++indexReg)
-								{
-									register_sum += 0x20;
-								}
-							}
-							else
-							{
-								register_sum += reg_index;
-							}
-						}
-
-						if (opcodeName == "mr")
-						{
-							switch (register_count)
-							{
-							case 0: {
-								kBytes.push_back(0x78);
-
-								char numIndex = 0x3;
-
-								for (size_t i = 0; i != reg_index; i++)
-								{
-									numIndex += 0x8;
-								}
-
-								kBytes.push_back(numIndex);
-
-								break;
-							}
-							case 1: {
-								char numIndex = 0x1;
-
-								for (size_t i = 0; i != reg_index; i++)
-								{
-									numIndex += 0x20;
-								}
-
-								for (size_t i = 0; i != reg_index; i++)
-								{
-									kBytes[kBytes.size() - 1] += 0x8;
-								}
-
-								kBytes[kBytes.size() - 1] -= 0x8;
-
-								kBytes.push_back(numIndex);
-
-								if (reg_index >= 10 && reg_index < 20)
-									kBytes.push_back(0x7d);
-								else if (reg_index >= 20 && reg_index < 30)
-									kBytes.push_back(0x7e);
-								else if (reg_index >= 30)
-									kBytes.push_back(0x7f);
-								else
-									kBytes.push_back(0x7c);
-
-								break;
-							}
-							default:
-								break;
-							}
-
-							++register_count;
-							++found_some_count;
-						}
-
-						if (opcodeName == "addi")
-						{
-							if (found_some_count == 2 || found_some_count == 0)
-								kBytes.emplace_back(reg_index);
-							else if (found_some_count == 1)
-								kBytes.emplace_back(0x00);
-
-							++found_some_count;
-
-							if (found_some_count > 3)
-							{
-								Detail::print_error("Too much registers. -> " + line, file);
-								throw std::runtime_error("too_much_regs");
-							}
-						}
-
-						if (opcodeName.find("cmp") != std::string::npos)
-						{
-							++found_some_count;
-
-							if (found_some_count > 3)
-							{
-								Detail::print_error("Too much registers. -> " + line, file);
-								throw std::runtime_error("too_much_regs");
-							}
-						}
-
-						if (opcodeName.find("mf") != std::string::npos ||
-							opcodeName.find("mt") != std::string::npos)
-						{
-							char numIndex = 0;
-
-							for (size_t i = 0; i != reg_index; i++)
-							{
-								numIndex += 0x20;
-							}
-
-							num.number[2] += numIndex;
-
-							++found_some_count;
-
-							if (found_some_count > 1)
-							{
-								Detail::print_error("Too much registers. -> " + line, file);
-								throw std::runtime_error("too_much_regs");
-							}
-
-							if (kVerbose)
-							{
-								kStdOut << "AssemblerPower: Found register: " << register_syntax
-										<< "\n";
-								kStdOut << "AssemblerPower: Amount of registers in instruction: "
-										<< found_some_count << "\n";
-							}
-
-							if (reg_index >= 10 && reg_index < 20)
-								num.number[3] = 0x7d;
-							else if (reg_index >= 20 && reg_index < 30)
-								num.number[3] = 0x7e;
-							else if (reg_index >= 30)
-								num.number[3] = 0x7f;
-							else
-								num.number[3] = 0x7c;
-
-							for (auto ch : num.number)
-							{
-								kBytes.emplace_back(ch);
-							}
-						}
-
-						found_registers_index.push_back(reg_index);
+						register_sum += 0x20;
 					}
 				}
-
-				if (opcodeName == "addi")
+				else
 				{
-					kBytes.emplace_back(0x38);
+					register_sum += reg_index;
 				}
+			}
 
-				if (opcodeName.find("cmp") != std::string::npos)
+			if (opcodeName == "mr")
+			{
+				switch (register_count)
 				{
-					char rightReg = 0x0;
+				case 0: {
+					kBytes.Append(0x78);
+
+					char numIndex = 0x3;
 
-					for (size_t i = 0; i != found_registers_index[1]; i++)
+					for (size_t i = 0; i != reg_index; i++)
 					{
-						rightReg += 0x08;
+						numIndex += 0x8;
 					}
 
-					kBytes.emplace_back(0x00);
-					kBytes.emplace_back(rightReg);
-					kBytes.emplace_back(found_registers_index[0]);
-					kBytes.emplace_back(0x7c);
+					kBytes.Append(numIndex);
+
+					break;
 				}
+				case 1: {
+					char numIndex = 0x1;
 
-				if ((opcodeName[0] == 's' && opcodeName[1] == 't'))
-				{
-					size_t offset = 0UL;
+					for (size_t i = 0; i != reg_index; i++)
+					{
+						numIndex += 0x20;
+					}
 
-					if (line.find('+') != std::string::npos)
+					std::uint8_t prevIndex = kBytes.At(kBytes.Size() - 1);
+
+					for (size_t i = 0; i != reg_index; i++)
 					{
-						auto number = GetNumber32(line.substr(line.find("+")), "+");
-						offset		= number.raw;
+						prevIndex += 0x8;
 					}
 
-					kBytes.push_back(offset);
-					kBytes.push_back(0x00);
-					kBytes.push_back(register_sum);
+					prevIndex -= 0x8;
+
+					kBytes.Patch(kBytes.Size() - 1, &prevIndex, sizeof(prevIndex));
 
-					kBytes.emplace_back(0x90);
+					kBytes.Append(numIndex);
+
+					if (reg_index >= 10 && reg_index < 20)
+						kBytes.Append(0x7d);
+					else if (reg_index >= 20 && reg_index < 30)
+						kBytes.Append(0x7e);
+					else if (reg_index >= 30)
+						kBytes.Append(0x7f);
+					else
+						kBytes.Append(0x7c);
+
+					break;
+				}
+				default:
+					break;
 				}
 
-				if (opcodeName == "mr")
+				++register_count;
+				++found_some_count;
+			}
+
+			if (opcodeName == "addi")
+			{
+				if (found_some_count == 2 || found_some_count == 0)
+					kBytes.Append(reg_index);
+				else if (found_some_count == 1)
+					kBytes.Append(0x00);
+
+				++found_some_count;
+
+				if (found_some_count > 3)
 				{
-					if (register_count == 1)
-					{
-						Detail::print_error("Too few registers. -> " + line, file);
-						throw std::runtime_error("too_few_registers");
-					}
+					Detail::print_error("Too much registers. -> " + line, file);
+					throw std::runtime_error("too_much_regs");
+				}
+			}
+
+			if (opcodeName.find("cmp") != std::string::npos)
+			{
+				++found_some_count;
+
+				if (found_some_count > 3)
+				{
+					Detail::print_error("Too much registers. -> " + line, file);
+					throw std::runtime_error("too_much_regs");
 				}
+			}
 
-				// we're not in immediate addressing, reg to reg.
-				if (opcode_risc.ops->type != GREG)
+			if (opcodeName.find("mf") != std::string::npos ||
+				opcodeName.find("mt") != std::string::npos)
+			{
+				char numIndex = 0;
+
+				for (size_t i = 0; i != reg_index; i++)
 				{
-					// remember! register to register!
-					if (found_some_count == 1)
-					{
-						Detail::print_error(
-							"Unrecognized register found.\ntip: each AssemblerPower register "
-							"starts with 'r'.\nline: " +
-								line,
-							file);
+					numIndex += 0x20;
+				}
 
-						throw std::runtime_error("not_a_register");
-					}
+				num.number[2] += numIndex;
+
+				++found_some_count;
+
+				if (found_some_count > 1)
+				{
+					Detail::print_error("Too much registers. -> " + line, file);
+					throw std::runtime_error("too_much_regs");
 				}
 
-				if (found_some_count < 1 && name[0] != 'l' && name[0] != 's')
+				if (kVerbose)
 				{
-					Detail::print_error(
-						"invalid combination of opcode and registers.\nline: " + line,
-						file);
-					throw std::runtime_error("invalid_comb_op_reg");
+					kStdOut << "AssemblerPower: Found register: " << register_syntax
+							<< "\n";
+					kStdOut << "AssemblerPower: Amount of registers in instruction: "
+							<< found_some_count << "\n";
 				}
 
-				break;
+				if (reg_index >= 10 && reg_index < 20)
+					num.number[3] = 0x7d;
+				else if (reg_index >= 20 && reg_index < 30)
+					num.number[3] = 0x7e;
+				else if (reg_index >= 30)
+					num.number[3] = 0x7f;
+				else
+					num.number[3] = 0x7c;
+
+				for (auto ch : num.number)
+				{
+					kBytes.Append(ch);
+				}
+			}
+
+			found_registers_index.push_back(reg_index);
+		}
+
+		if (opcodeName == "addi")
+		{
+			kBytes.Append(0x38);
+		}
+
+		if (opcodeName.find("cmp") != std::string::npos)
+		{
+			char rightReg = 0x0;
+
+			for (size_t i = 0; i != found_registers_index[1]; i++)
+			{
+				rightReg += 0x08;
+			}
+
+			kBytes.Append(0x00);
+			kBytes.Append(rightReg);
+			kBytes.Append(found_registers_index[0]);
+			kBytes.Append(0x7c);
+		}
+
+		if ((opcodeName[0] == 's' && opcodeName[1] == 't'))
+		{
+			size_t offset = 0UL;
+
+			// the offset follows the base register, as in r1+8.
+			for (std::size_t operand_index = 0UL; operand_index < tokens.fOperandCount; ++operand_index)
+			{
+				if (auto plus = tokens.fOperands[operand_index].find('+'); plus != std::string_view::npos)
+					offset = GetNumber32(std::string(tokens.fOperands[operand_index].substr(plus + 1)), "").raw;
+			}
+
+			kBytes.Append(offset);
+			kBytes.Append(0x00);
+			kBytes.Append(register_sum);
+
+			kBytes.Append(0x90);
+		}
+
+		if (opcodeName == "mr")
+		{
+			if (register_count == 1)
+			{
+				Detail::print_error("Too few registers. -> " + line, file);
+				throw std::runtime_error("too_few_registers");
 			}
+		}
+
+		// we're not in immediate addressing, reg to reg.
+		if (opcode_risc->ops->type != GREG)
+		{
+			// remember! register to register!
+			if (found_some_count == 1)
+			{
+				Detail::print_error(
+					"Unrecognized register found.\ntip: each AssemblerPower register "
+					"starts with 'r'.\nline: " +
+						line,
+					file);
+
+				throw std::runtime_error("not_a_register");
 			}
+		}
 
-			kOrigin += cPowerIPAlignment;
-			break;
+		if (found_some_count < 1 && name[0] != 'l' && name[0] != 's')
+		{
+			Detail::print_error(
+				"invalid combination of opcode and registers.\nline: " + line,
+				file);
+			throw std::runtime_error("invalid_comb_op_reg");
 		}
+
+		break;
 	}
+	}
+
+	kOrigin += cPowerIPAlignment;
 
 	return true;
 }
@@ -20,6 +20,7 @@
 // extern_segment, @autodelete { ... }, fn foo() -> auto { ... }
 
 #include <LibCompiler/Backend/amd64.h>
+#include <LibCompiler/LinePipe.h>
 #include <LibCompiler/Parser.h>
 #include <LibCompiler/UUID.h>
 
@@ -99,7 +100,7 @@ namespace Detail
 		std::vector<CompilerRegisterMap> fStackMapVector;
 		std::vector<CompilerStructMap>	 fStructMapVector;
 		LibCompiler::SyntaxLeafList*	 fSyntaxTree{nullptr};
-		std::unique_ptr<std::ofstream>	 fOutputAssembly;
+		std::ostream*					 fOutputAssembly{nullptr};
 		std::string						 fLastFile;
 		std::string						 fLastError;
 		Boolean							 fVerbose;
@@ -923,11 +924,19 @@ public:
 			dest += uuids::to_string(id);
 		}
 
-		kState.fOutputAssembly = std::make_unique<std::ofstream>(dest);
+		std::ofstream dest_fp(dest);
+
+		return this->CompileStream(src_file, src_fp, dest_fp);
+	}
+
+	/// @brief Compile the lines of src_fp to out, src is the name of the source.
+	Int32 CompileStream(std::string& src, std::istream& src_fp, std::ostream& out)
+	{
+		kState.fOutputAssembly = &out;
 
 		auto fmt = LibCompiler::current_date();
 
-		(*kState.fOutputAssembly) << "; Repository Path: /" << src_file << "\n";
+		(*kState.fOutputAssembly) << "; Repository Path: /" << src << "\n";
 
 		std::filesystem::path path = std::filesystem::path("./");
 
@@ -975,7 +984,7 @@ public:
 		}
 
 		kState.fOutputAssembly->flush();
-		kState.fOutputAssembly->close();
+		kState.fOutputAssembly = nullptr;
 
 		delete kState.fSyntaxTree;
 		kState.fSyntaxTree = nullptr;
@@ -1003,9 +1012,16 @@ static void cxx_print_help()
 		".cpp", ".cxx", ".cc", ".c++", ".cp" \
 	}
 
-LIBCOMPILER_MODULE(CompilerCPlusPlusAMD64)
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @brief Register the keywords and mount the compiler, once per process.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+static void cxx_mount()
 {
-	Boolean skip = false;
+	if (kCompilerFrontend)
+		return;
 
 	kKeywords.push_back({.keyword_name = "if", .keyword_kind = LibCompiler::kKeywordKindIf});
 	kKeywords.push_back({.keyword_name = "else", .keyword_kind = LibCompiler::kKeywordKindElse});
@@ -1067,6 +1083,45 @@ LIBCOMPILER_MODULE(CompilerCPlusPlusAMD64)
 
 	kFactory.Mount(new AssemblyCPlusPlusInterface());
 	kCompilerFrontend = new CompilerFrontendCPlusPlus();
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @brief Pipeline entrypoint, compile the lines of in, the assembly goes to out.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+LC_IMPORT_C int CompilerCPlusPlusAMD64Pipe(const char* file, LibCompiler::LinePipe* in, LibCompiler::LinePipe* out)
+{
+	cxx_mount();
+
+	LibCompiler::LinePipeReader reader(*in);
+	LibCompiler::LinePipeWriter writer(*out);
+
+	std::istream src_fp(&reader);
+	std::ostream dest_fp(&writer);
+
+	std::string src = file;
+
+	std::cout << "CPlusPlusCompilerAMD64: Building: " << src << std::endl;
+
+	AssemblyCPlusPlusInterface compiler;
+
+	auto code = compiler.CompileStream(src, src_fp, dest_fp);
+
+	writer.Flush();
+
+	out->Close();
+	in->Close();
+
+	return code;
+}
+
+LIBCOMPILER_MODULE(CompilerCPlusPlusAMD64)
+{
+	Boolean skip = false;
+
+	cxx_mount();
 
 	for (auto index = 1UL; index < argc; ++index)
 	{
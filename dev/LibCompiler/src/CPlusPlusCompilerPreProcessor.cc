@@ -11,15 +11,34 @@
 
 #include <LibCompiler/Parser.h>
 #include <LibCompiler/ErrorID.h>
+#include <LibCompiler/LinePipe.h>
 #include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <stdexcept>
+#include <streambuf>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #define kMacroPrefix '#'
 
+#define kPchMagic	"bpch"
+#define kPchExt		".bpch"
+#define kPchVersion (1)
+
+#define kStampMagic	  "bpps"
+#define kStampExt	  ".stamp"
+#define kStampVersion (1)
+
 /// @author EL Mahrouss Amlal (amlel)
 /// @file bpp.cxx
 /// @brief Preprocessor.
@@ -34,20 +53,20 @@ typedef Int32 (*bpp_parser_fn_t)(std::string& line, std::ifstream& hdr_file, std
 
 namespace Detail
 {
-	enum
+	/// @brief An #if block, up to its #endif.
+	struct bpp_conditional final
 	{
-		kEqual,
-		kGreaterEqThan,
-		kLesserEqThan,
-		kGreaterThan,
-		kLesserThan,
-		kNotEqual,
+		bool fParentActive{true}; // the block it is in is active.
+		bool fActive{true};		  // the current branch is active.
+		bool fTaken{false};		  // a branch was active, the next ones aren't.
+		bool fElse{false};		  // #else was seen.
 	};
 
-	struct bpp_macro_condition final
+	/// @brief A token of an #if expression, an operator or a number.
+	struct bpp_token final
 	{
-		int32_t		fType;
-		std::string fTypeName;
+		std::string_view fOp; // empty for a number.
+		std::int64_t	 fValue{0};
 	};
 
 	struct bpp_macro final
@@ -79,690 +98,1474 @@ namespace Detail
 		std::string		fMacroName;
 		bpp_parser_fn_t fParse;
 	};
-} // namespace Detail
-
-static std::vector<std::string>		  kFiles;
-static std::vector<Detail::bpp_macro> kMacros;
-static std::vector<std::string>		  kIncludes;
 
-static std::string kWorkingDir;
+	/// @brief Hashes macro names, so that the table is searched with a string_view.
+	struct bpp_macro_hash final
+	{
+		using is_transparent = void;
 
-static std::vector<std::string> kKeywords = {
-	"include", "if", "pragma", "def", "elif",
-	"ifdef", "ifndef", "else", "warning", "error"};
+		std::size_t operator()(std::string_view name) const noexcept
+		{
+			return std::hash<std::string_view>{}(name);
+		}
+	};
 
-#define kKeywordCxxCnt kKeywords.size()
+	/// @brief Macros by name, a definition replaces the previous one.
+	using bpp_macro_map = std::unordered_map<std::string, bpp_macro, bpp_macro_hash, std::equal_to<>>;
 
-/////////////////////////////////////////////////////////////////////////////////////////
+	/// @brief A header file, read once per process and shared by every translation unit.
+	struct bpp_header final
+	{
+		std::string	  fPath;
+		std::string	  fContents;
+		std::string	  fGuard;	  // the macro of the include guard wrapping the whole file, if any.
+		std::uint64_t fHash{0UL}; // hash of the contents.
+	};
 
-// @name bpp_parse_if_condition
-// @brief parse #if condition
+	/// @brief Files and the hash of their contents.
+	using bpp_depends = std::vector<std::pair<std::string, std::uint64_t>>;
 
-/////////////////////////////////////////////////////////////////////////////////////////
+	/// @brief What including a header did, replayed when it's included again in the same state.
+	struct bpp_header_state final
+	{
+		std::string										   fText;	  // its expanded text.
+		std::vector<bpp_macro>							   fMacros;	  // the macros it defined, in order.
+		std::vector<std::string>						   fIncludes; // the include lines it added.
+		std::vector<std::string>						   fOnce;	  // the headers it marked #pragma once.
+		std::vector<std::pair<std::string, std::uint64_t>> fDepends;  // the headers it read, and their hash.
+	};
 
-int32_t bpp_parse_if_condition(Detail::bpp_macro_condition& cond,
-							   Detail::bpp_macro&			macro,
-							   bool&						inactive_code,
-							   bool&						defined,
-							   std::string&					macro_str)
-{
-	if (cond.fType == Detail::kEqual)
+	/// @brief The state of a translation unit, each file is preprocessed in its own.
+	struct bpp_context final
 	{
-		auto substr_macro =
-			macro_str.substr(macro_str.find(macro.fName) + macro.fName.size());
+		bpp_macro_map						  fMacros;
+		std::vector<std::string>			  fAllIncludes; // every include line seen.
+		std::unordered_set<const bpp_header*> fOnce;		// the headers with a #pragma once.
+		std::vector<const bpp_header*>		  fHeaderStack; // the headers being parsed.
+		std::vector<bpp_header_state*>		  fRecording;	// the header states being recorded.
+		bpp_depends							  fDepends;		// every header read, for --bpp:deps.
+		std::uint64_t						  fMacroState{0UL};
+		std::uint64_t						  fIncludeState{0UL};
+	};
 
-		if (substr_macro.find(macro.fValue) != std::string::npos)
+	/// @brief Reads a header out of its contents, without copying them.
+	class bpp_header_buf final : public std::streambuf
+	{
+	public:
+		explicit bpp_header_buf(const std::string& contents)
 		{
-			if (macro.fValue == "0")
-			{
-				defined		  = false;
-				inactive_code = true;
+			char* begin = const_cast<char*>(contents.data());
+			this->setg(begin, begin, begin + contents.size());
+		}
+	};
+} // namespace Detail
 
-				return 1;
-			}
+static std::vector<std::string> kFiles;
+static std::vector<std::string> kIncludes;
 
-			defined		  = true;
-			inactive_code = false;
+/* builtin and command line macros, read only once files are preprocessed, each one starts with them. */
+static Detail::bpp_macro_map kMacros;
+static std::uint64_t		 kMacroState = 0UL;
 
-			return 1;
-		}
-	}
-	else if (cond.fType == Detail::kNotEqual)
-	{
-		auto substr_macro =
-			macro_str.substr(macro_str.find(macro.fName) + macro.fName.size());
+static std::string kWorkingDir;
 
-		if (substr_macro.find(macro.fName) != std::string::npos)
-		{
-			if (substr_macro.find(macro.fValue) != std::string::npos)
-			{
-				defined		  = false;
-				inactive_code = true;
+/* include names to the file they resolve to, empty if there is none. */
+static std::unordered_map<std::string, std::string> kIncludeFiles;
 
-				return 1;
-			}
+/* resolved file to its header. */
+static std::unordered_map<std::string, std::unique_ptr<Detail::bpp_header>> kHeaders;
 
-			defined		  = true;
-			inactive_code = false;
+/* header states by key, and where they are kept between runs. */
+static std::unordered_map<std::uint64_t, std::shared_ptr<Detail::bpp_header_state>> kHeaderStates;
+static std::string																	 kPchDir;
 
-			return 1;
-		}
+/* guards the include, header and header state caches, translation units share them. */
+static std::mutex kCacheLock;
 
-		return 0;
-	}
+/* the include dirs summed up in a hash. */
+static std::uint64_t kConfigState = 0UL;
+
+/* files preprocessed at once. */
+static std::size_t kJobs = 1UL;
+
+/* the depfile to write, and whether a .pp newer than what it was made of is kept. */
+static std::string kDepsFile;
+static bool		   kSkipUnchanged = false;
+
+static std::vector<std::string> kKeywords = {
+	"include", "if", "pragma", "def", "elif",
+	"ifdef", "ifndef", "else", "warning", "error"};
 
-	auto substr_macro =
-		macro_str.substr(macro_str.find(macro.fName) + macro.fName.size());
+#define kKeywordCxxCnt kKeywords.size()
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_resolve_include
+// @brief find the file of an include, every name is looked up once.
 
-	std::string number;
+/////////////////////////////////////////////////////////////////////////////////////////
+
+const std::string& bpp_resolve_include(const std::string& path, bool not_local)
+{
+	auto key = (not_local ? "<" : "\"") + path;
 
-	for (auto& macro_num : kMacros)
 	{
-		if (substr_macro.find(macro_num.fName) != std::string::npos)
-		{
-			for (size_t i = 0; i < macro_num.fName.size(); ++i)
-			{
-				if (isdigit(macro_num.fValue[i]))
-				{
-					number += macro_num.fValue[i];
-				}
-				else
-				{
-					number.clear();
-					break;
-				}
-			}
+		std::lock_guard lock(kCacheLock);
 
-			break;
-		}
+		if (auto it = kIncludeFiles.find(key); it != kIncludeFiles.end())
+			return it->second;
 	}
 
-	size_t y = 2;
+	std::string resolved;
 
-	/* last try */
-	for (; y < macro_str.size(); y++)
+	if (not_local)
 	{
-		if (isdigit(macro_str[y]))
+		for (auto& include : kIncludes)
 		{
-			for (size_t x = y; x < macro_str.size(); x++)
-			{
-				if (macro_str[x] == ' ')
-					break;
+			std::string header_path = include;
+			header_path.push_back('-');
+			header_path += path;
 
-				number += macro_str[x];
+			if (std::filesystem::is_regular_file(header_path))
+			{
+				resolved = header_path;
+				break;
 			}
-
-			break;
 		}
 	}
+	else if (std::filesystem::is_regular_file(path))
+	{
+		resolved = path;
+	}
 
-	size_t rhs = atol(macro.fValue.c_str());
-	size_t lhs = atol(number.c_str());
+	std::lock_guard lock(kCacheLock);
 
-	if (lhs == 0)
-	{
-		number.clear();
-		++y;
+	return kIncludeFiles.emplace(std::move(key), std::move(resolved)).first->second;
+}
 
-		for (; y < macro_str.size(); y++)
-		{
-			if (isdigit(macro_str[y]))
-			{
-				for (size_t x = y; x < macro_str.size(); x++)
-				{
-					if (macro_str[x] == ' ')
-						break;
+/////////////////////////////////////////////////////////////////////////////////////////
 
-					number += macro_str[x];
-				}
+// @name bpp_find_guard
+// @brief the macro of an #ifndef/#define/#endif guard wrapping the whole header, or nothing.
 
-				break;
-			}
-		}
+/////////////////////////////////////////////////////////////////////////////////////////
 
-		lhs = atol(number.c_str());
-	}
+std::string bpp_find_guard(const std::string& contents)
+{
+	std::vector<std::string_view> lines;
 
-	if (cond.fType == Detail::kGreaterThan)
+	for (std::size_t start = 0UL; start < contents.size();)
 	{
-		if (lhs < rhs)
-		{
-			defined		  = true;
-			inactive_code = false;
+		auto end = std::min(contents.find('\n', start), contents.size());
+		auto line = std::string_view(contents).substr(start, end - start);
 
-			return 1;
-		}
+		start = end + 1;
 
-		return 0;
+		if (auto first = line.find_first_not_of(" \t\r"); first != std::string_view::npos)
+			lines.push_back(line.substr(first));
 	}
 
-	if (cond.fType == Detail::kGreaterEqThan)
-	{
-		if (lhs <= rhs)
-		{
-			defined		  = true;
-			inactive_code = false;
+	// the name of the macro a directive is about.
+	auto macro_of = [](std::string_view line, std::string_view directive) {
+		auto name = line.substr(directive.size());
+		name	  = name.substr(std::min(name.size(), name.find_first_not_of(" \t")));
 
-			return 1;
-		}
+		return name.substr(0, name.find_first_of(" \t\r("));
+	};
 
-		return 0;
-	}
+	if (lines.size() < 3UL || !lines.front().starts_with("#ifndef") || !lines[1].starts_with("#define ") ||
+		!lines.back().starts_with("#endif"))
+		return "";
 
-	if (cond.fType == Detail::kLesserEqThan)
-	{
-		if (lhs >= rhs)
-		{
-			defined		  = true;
-			inactive_code = false;
+	auto guard = macro_of(lines.front(), "#ifndef");
 
-			return 1;
-		}
+	if (guard.empty() || macro_of(lines[1], "#define ") != guard)
+		return "";
 
-		return 0;
-	}
+	// the #endif of the guard has to be the last line.
+	std::size_t depth = 0UL;
 
-	if (cond.fType == Detail::kLesserThan)
+	for (std::size_t line = 0UL; line < lines.size(); ++line)
 	{
-		if (lhs > rhs)
-		{
-			defined		  = true;
-			inactive_code = false;
-
-			return 1;
-		}
-
-		return 0;
+		if (lines[line].starts_with("#if"))
+			++depth;
+		else if (lines[line].starts_with("#endif") && --depth == 0UL && line + 1 < lines.size())
+			return "";
 	}
 
-	return 0;
+	return std::string(guard);
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
-// @brief stores every included file here.
+// @name bpp_hash
+// @brief FNV-1a hash of bytes, chained through seed.
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
-std::vector<std::string> kAllIncludes;
+std::uint64_t bpp_hash(std::string_view bytes, std::uint64_t seed = 14695981039346656037ULL)
+{
+	for (auto ch : bytes)
+	{
+		seed ^= static_cast<unsigned char>(ch);
+		seed *= 1099511628211ULL;
+	}
+
+	return seed;
+}
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
-// @name bpp_parse_file
-// @brief parse file to preprocess it.
+// @name bpp_read_header
+// @brief read a header once per process, nullptr if it can't be read.
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
-void bpp_parse_file(std::ifstream& hdr_file, std::ofstream& pp_out)
+const Detail::bpp_header* bpp_read_header(const std::string& resolved)
 {
-	std::string hdr_line;
-	std::string line_after_include;
-
-	bool inactive_code = false;
-	bool defined	   = false;
-
-	try
 	{
-		while (std::getline(hdr_file, hdr_line))
-		{
-			if (inactive_code)
-			{
-				if (hdr_line.find("#endif") == std::string::npos)
-				{
-					continue;
-				}
-				else if (hdr_line[0] == kMacroPrefix &&
-						 hdr_line.find("#endif") != std::string::npos)
-				{
+		std::lock_guard lock(kCacheLock);
 
-					inactive_code = false;
-				}
+		if (auto it = kHeaders.find(resolved); it != kHeaders.end())
+			return it->second.get();
+	}
 
-				if (hdr_line.find("*/") != std::string::npos)
-				{
-					continue;
-				}
-			}
+	std::ifstream file(resolved, std::ifstream::binary | std::ifstream::ate);
 
-			if (hdr_line.find("--/") != std::string::npos)
-			{
-				hdr_line.erase(hdr_line.find("--/"));
-			}
+	if (!file.is_open())
+		return nullptr;
 
-			if (hdr_line.find("--*") != std::string::npos)
-			{
-				inactive_code = true;
-				// get rid of comment.
-				hdr_line.erase(hdr_line.find("--*"));
-			}
+	auto header	  = std::make_unique<Detail::bpp_header>();
+	header->fPath = resolved;
 
-			/// BPP 'brief' documentation.
-			if (hdr_line.find("@brief") != std::string::npos)
-			{
-				hdr_line.erase(hdr_line.find("@brief"));
+	header->fContents.resize(file.tellg());
+	file.seekg(0);
 
-				// TODO: Write an <file_name>.html or append to it.
-			}
+	if (!file.read(header->fContents.data(), header->fContents.size()))
+		return nullptr;
 
-			if (hdr_line[0] == kMacroPrefix &&
-				hdr_line.find("endif") != std::string::npos)
-			{
-				if (!defined && inactive_code)
-				{
-					inactive_code = false;
-					defined		  = false;
+	header->fGuard = bpp_find_guard(header->fContents);
+	header->fHash  = bpp_hash(header->fContents);
 
-					continue;
-				}
+	// another translation unit may have read it meanwhile, the first one is kept.
+	std::lock_guard lock(kCacheLock);
 
-				continue;
-			}
+	return kHeaders.emplace(resolved, std::move(header)).first->second.get();
+}
 
-			if (!defined && inactive_code)
-			{
-				continue;
-			}
+/////////////////////////////////////////////////////////////////////////////////////////
 
-			if (defined && inactive_code)
-			{
-				continue;
-			}
+// @name bpp_define
+// @brief define a macro, the headers being recorded define it too when replayed.
 
-			for (auto macro : kMacros)
-			{
-				if (LibCompiler::find_word(hdr_line, macro.fName))
-				{
-					if (hdr_line.substr(hdr_line.find(macro.fName)).find(macro.fName + '(') != LibCompiler::String::npos)
-					{
-						if (!macro.fArgs.empty())
-						{
-							LibCompiler::String				 symbol_val = macro.fValue;
-							std::vector<LibCompiler::String> args;
+/////////////////////////////////////////////////////////////////////////////////////////
 
-							size_t x_arg_indx = 0;
+std::uint64_t bpp_hash_macro(const Detail::bpp_macro& macro)
+{
+	auto hash = bpp_hash(macro.fValue, bpp_hash({"", 1}, bpp_hash(macro.fName)));
 
-							LibCompiler::String line_after_define = hdr_line;
-							LibCompiler::String str_arg;
+	for (auto& arg : macro.fArgs)
+		hash = bpp_hash(arg, bpp_hash({"", 1}, hash));
 
-							if (line_after_define.find("(") != LibCompiler::String::npos)
-							{
-								line_after_define.erase(0, line_after_define.find("(") + 1);
+	return hash;
+}
 
-								for (auto& subc : line_after_define)
-								{
-									if (subc == ' ' || subc == '\t')
-										continue;
+void bpp_define(Detail::bpp_context& context, Detail::bpp_macro macro)
+{
+	for (auto recording : context.fRecording)
+		recording->fMacros.push_back(macro);
 
-									if (subc == ',' || subc == ')')
-									{
-										if (str_arg.empty())
-											continue;
+	// the state is a sum, a definition takes the one it replaces out of it.
+	auto& slot = context.fMacros[macro.fName];
 
-										args.push_back(str_arg);
+	if (!slot.fName.empty())
+		context.fMacroState -= bpp_hash_macro(slot);
 
-										str_arg.clear();
+	context.fMacroState += bpp_hash_macro(macro);
+	slot = std::move(macro);
+}
 
-										continue;
-									}
+/////////////////////////////////////////////////////////////////////////////////////////
 
-									str_arg.push_back(subc);
-								}
-							}
+// @name bpp_add_include
+// @brief remember an include line, it isn't included again.
 
-							for (auto arg : macro.fArgs)
-							{
-								if (symbol_val.find(macro.fArgs[x_arg_indx]) != LibCompiler::String::npos)
-								{
-									symbol_val.replace(symbol_val.find(macro.fArgs[x_arg_indx]), macro.fArgs[x_arg_indx].size(),
-													   args[x_arg_indx]);
-									++x_arg_indx;
-								}
-								else
-								{
-									throw std::runtime_error("bpp: Internal error.");
-								}
-							}
+/////////////////////////////////////////////////////////////////////////////////////////
 
-							auto len = macro.fName.size();
-							len += symbol_val.size();
-							len += 2; // ( and )
+void bpp_add_include(Detail::bpp_context& context, const std::string& line)
+{
+	for (auto recording : context.fRecording)
+		recording->fIncludes.push_back(line);
 
-							hdr_line.erase(hdr_line.find(")"), 1);
+	context.fAllIncludes.push_back(line);
+	context.fIncludeState += bpp_hash(line);
+}
 
-							hdr_line.replace(hdr_line.find(hdr_line.substr(hdr_line.find(macro.fName + '('))), len,
-											 symbol_val);
-						}
-						else
-						{
-							auto value = macro.fValue;
+/////////////////////////////////////////////////////////////////////////////////////////
 
-							hdr_line.replace(hdr_line.find(macro.fName), macro.fName.size(),
-											 value);
-						}
-					}
-				}
-			}
+// @name bpp_mark_once
+// @brief mark a header #pragma once.
 
-			if (hdr_line[0] == kMacroPrefix &&
-				hdr_line.find("define ") != std::string::npos)
-			{
-				auto line_after_define =
-					hdr_line.substr(hdr_line.find("define ") + strlen("define "));
+/////////////////////////////////////////////////////////////////////////////////////////
 
-				std::string macro_value;
-				std::string macro_key;
+void bpp_mark_once(Detail::bpp_context& context, const Detail::bpp_header* header)
+{
+	if (!context.fOnce.insert(header).second)
+		return;
 
-				std::size_t pos = 0UL;
+	for (auto recording : context.fRecording)
+		recording->fOnce.push_back(header->fPath);
 
-				std::vector<std::string> args;
-				bool					 on_args = false;
+	context.fIncludeState += bpp_hash(header->fPath, bpp_hash("#pragma once"));
+}
 
-				for (auto& ch : line_after_define)
-				{
-					++pos;
+/////////////////////////////////////////////////////////////////////////////////////////
 
-					if (ch == '(')
-					{
-						on_args = true;
-						continue;
-					}
+// @name bpp_add_depend
+// @brief the translation unit, and the headers being recorded, depend on this one.
 
-					if (ch == ')')
-					{
-						on_args = false;
-						continue;
-					}
+/////////////////////////////////////////////////////////////////////////////////////////
 
-					if (ch == '\\')
-						continue;
+void bpp_add_depend(Detail::bpp_context& context, const std::string& path, std::uint64_t hash)
+{
+	for (auto recording : context.fRecording)
+		recording->fDepends.emplace_back(path, hash);
 
-					if (on_args)
-						continue;
+	context.fDepends.emplace_back(path, hash);
+}
 
-					if (ch == ' ')
-					{
-						for (size_t i = pos; i < line_after_define.size(); i++)
-						{
-							macro_value += line_after_define[i];
-						}
+/////////////////////////////////////////////////////////////////////////////////////////
 
-						break;
-					}
+// @name bpp_header_key
+// @brief a header's contents, and the state it is included in.
 
-					macro_key += ch;
-				}
+/////////////////////////////////////////////////////////////////////////////////////////
 
-				std::string str;
+std::uint64_t bpp_header_key(const Detail::bpp_context& context, const Detail::bpp_header* header)
+{
+	std::uint64_t key[] = {header->fHash, context.fMacroState, context.fIncludeState, kConfigState};
 
-				if (line_after_define.find("(") != LibCompiler::String::npos)
-				{
-					line_after_define.erase(0, line_after_define.find("(") + 1);
+	return bpp_hash({reinterpret_cast<const char*>(key), sizeof(key)});
+}
 
-					for (auto& subc : line_after_define)
-					{
-						if (subc == ',' || subc == ')')
-						{
-							if (str.empty())
-								continue;
+/////////////////////////////////////////////////////////////////////////////////////////
 
-							args.push_back(str);
+// @name bpp_pch_path
+// @brief the file a header state is kept in, under --bpp:pch-dir.
 
-							str.clear();
+/////////////////////////////////////////////////////////////////////////////////////////
 
-							continue;
-						}
+std::string bpp_pch_path(std::uint64_t key)
+{
+	char name[32] = {0};
+	snprintf(name, sizeof(name), "%016llx" kPchExt, static_cast<unsigned long long>(key));
 
-						str.push_back(subc);
-					}
-				}
+	return kPchDir + "/" + name;
+}
 
-				Detail::bpp_macro macro;
+void bpp_put_u64(std::string& out, std::uint64_t value)
+{
+	out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
 
-				macro.fArgs	 = args;
-				macro.fName	 = macro_key;
-				macro.fValue = macro_value;
+void bpp_put_string(std::string& out, std::string_view str)
+{
+	bpp_put_u64(out, str.size());
+	out += str;
+}
 
-				kMacros.emplace_back(macro);
+bool bpp_get_u64(std::string_view& in, std::uint64_t& value)
+{
+	if (in.size() < sizeof(value))
+		return false;
 
-				continue;
-			}
+	memcpy(&value, in.data(), sizeof(value));
+	in.remove_prefix(sizeof(value));
 
-			if (hdr_line[0] != kMacroPrefix)
-			{
-				if (inactive_code)
-				{
-					continue;
-				}
+	return true;
+}
+
+bool bpp_get_string(std::string_view& in, std::string& str)
+{
+	std::uint64_t size = 0UL;
+
+	if (!bpp_get_u64(in, size) || size > in.size())
+		return false;
+
+	str.assign(in.substr(0, size));
+	in.remove_prefix(size);
+
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_save_header_state
+// @brief keep a header state, and write it under --bpp:pch-dir.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+void bpp_save_header_state(std::uint64_t key, std::shared_ptr<Detail::bpp_header_state> state)
+{
+	{
+		std::lock_guard lock(kCacheLock);
+		kHeaderStates[key] = state;
+	}
+
+	if (kPchDir.empty())
+		return;
+
+	std::string out = kPchMagic;
+
+	bpp_put_u64(out, kPchVersion);
+	bpp_put_u64(out, key);
+	bpp_put_string(out, state->fText);
+	bpp_put_u64(out, state->fMacros.size());
+
+	for (auto& macro : state->fMacros)
+	{
+		bpp_put_string(out, macro.fName);
+		bpp_put_string(out, macro.fValue);
+		bpp_put_u64(out, macro.fArgs.size());
+
+		for (auto& arg : macro.fArgs)
+			bpp_put_string(out, arg);
+	}
+
+	bpp_put_u64(out, state->fIncludes.size());
+
+	for (auto& line : state->fIncludes)
+		bpp_put_string(out, line);
+
+	bpp_put_u64(out, state->fOnce.size());
+
+	for (auto& path : state->fOnce)
+		bpp_put_string(out, path);
+
+	bpp_put_u64(out, state->fDepends.size());
+
+	for (auto& [path, hash] : state->fDepends)
+	{
+		bpp_put_string(out, path);
+		bpp_put_u64(out, hash);
+	}
+
+	// written aside then renamed, a concurrent run never reads half a file.
+	auto path = bpp_pch_path(key);
+	auto temp = path + "." + std::to_string(getpid());
+
+	{
+		std::ofstream file(temp, std::ofstream::binary | std::ofstream::trunc);
+
+		if (!file.write(out.data(), out.size()))
+			return;
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(temp, path, ec);
+
+	if (ec)
+		std::filesystem::remove(temp, ec);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_load_header_state
+// @brief a header state kept in this run, or under --bpp:pch-dir, nullptr if there is none.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+std::shared_ptr<Detail::bpp_header_state> bpp_load_header_state(std::uint64_t key)
+{
+	{
+		std::lock_guard lock(kCacheLock);
+
+		if (auto it = kHeaderStates.find(key); it != kHeaderStates.end())
+			return it->second;
+	}
+
+	if (kPchDir.empty())
+		return nullptr;
+
+	std::ifstream file(bpp_pch_path(key), std::ifstream::binary | std::ifstream::ate);
+
+	if (!file.is_open())
+		return nullptr;
+
+	std::string contents(file.tellg(), 0);
+	file.seekg(0);
+
+	if (!file.read(contents.data(), contents.size()) || !contents.starts_with(kPchMagic))
+		return nullptr;
+
+	auto in	   = std::string_view(contents).substr(strlen(kPchMagic));
+	auto state = std::make_shared<Detail::bpp_header_state>();
+
+	std::uint64_t version = 0UL, file_key = 0UL, count = 0UL;
+
+	if (!bpp_get_u64(in, version) || version != kPchVersion || !bpp_get_u64(in, file_key) || file_key != key ||
+		!bpp_get_string(in, state->fText) || !bpp_get_u64(in, count))
+		return nullptr;
+
+	for (; count > 0UL; --count)
+	{
+		auto&		  macro	= state->fMacros.emplace_back();
+		std::uint64_t args = 0UL;
+
+		if (!bpp_get_string(in, macro.fName) || !bpp_get_string(in, macro.fValue) || !bpp_get_u64(in, args))
+			return nullptr;
+
+		for (; args > 0UL; --args)
+		{
+			if (!bpp_get_string(in, macro.fArgs.emplace_back()))
+				return nullptr;
+		}
+	}
+
+	if (!bpp_get_u64(in, count))
+		return nullptr;
+
+	for (; count > 0UL; --count)
+	{
+		if (!bpp_get_string(in, state->fIncludes.emplace_back()))
+			return nullptr;
+	}
+
+	if (!bpp_get_u64(in, count))
+		return nullptr;
+
+	for (; count > 0UL; --count)
+	{
+		if (!bpp_get_string(in, state->fOnce.emplace_back()))
+			return nullptr;
+	}
+
+	if (!bpp_get_u64(in, count))
+		return nullptr;
+
+	for (; count > 0UL; --count)
+	{
+		auto& [path, hash] = state->fDepends.emplace_back();
+
+		if (!bpp_get_string(in, path) || !bpp_get_u64(in, hash))
+			return nullptr;
+	}
+
+	std::lock_guard lock(kCacheLock);
+
+	return kHeaderStates.emplace(key, state).first->second;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_skip_literal
+// @brief the end of the string, character literal or number at pos, pos if there is none.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+std::size_t bpp_skip_literal(std::string_view text, std::size_t pos)
+{
+	if (text[pos] == '"' || text[pos] == '\'')
+	{
+		auto end = pos + 1;
+
+		while (end < text.size() && text[end] != text[pos])
+			end += text[end] == '\\' ? 2 : 1;
+
+		return std::min(end + 1, text.size());
+	}
+
+	// a number, along with its suffix (202302L isn't followed by the macro L).
+	if (isdigit(text[pos]))
+	{
+		auto end = pos;
+
+		while (end < text.size() && (isalnum(text[end]) || text[end] == '_' || text[end] == '.'))
+			++end;
+
+		return end;
+	}
+
+	return pos;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_identifier
+// @brief the identifier at pos, empty if there is none.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+std::string_view bpp_identifier(std::string_view text, std::size_t pos)
+{
+	if (!isalpha(text[pos]) && text[pos] != '_')
+		return {};
+
+	auto end = pos;
+
+	while (end < text.size() && (isalnum(text[end]) || text[end] == '_'))
+		++end;
+
+	return text.substr(pos, end - pos);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_expand
+// @brief expand the macros of text into out, it is scanned once, identifier by identifier.
+// @param active the macros being expanded, a macro isn't expanded again inside itself.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+void bpp_expand(const Detail::bpp_context& context, std::string_view text, std::string& out, std::vector<const Detail::bpp_macro*>& active)
+{
+	std::size_t pos = 0UL;
+
+	while (pos < text.size())
+	{
+		if (auto end = bpp_skip_literal(text, pos); end != pos)
+		{
+			out.append(text.substr(pos, end - pos));
+			pos = end;
+
+			continue;
+		}
 
-				pp_out << hdr_line << std::endl;
+		auto name = bpp_identifier(text, pos);
 
+		if (name.empty())
+		{
+			out.push_back(text[pos]);
+			++pos;
+
+			continue;
+		}
+
+		pos += name.size();
+
+		auto it = context.fMacros.find(name);
+
+		if (it == context.fMacros.end() || std::find(active.begin(), active.end(), &it->second) != active.end())
+		{
+			out.append(name);
+			continue;
+		}
+
+		auto& macro = it->second;
+
+		if (macro.fArgs.empty())
+		{
+			active.push_back(&macro);
+			bpp_expand(context, macro.fValue, out, active);
+			active.pop_back();
+
+			continue;
+		}
+
+		// a function-like macro is only expanded when it is called.
+		auto open = text.find_first_not_of(" \t", pos);
+
+		if (open == std::string_view::npos || text[open] != '(')
+		{
+			out.append(name);
+			continue;
+		}
+
+		std::vector<std::string_view> args;
+
+		std::size_t depth = 0UL;
+		std::size_t close = std::string_view::npos;
+
+		for (auto arg = open + 1, cursor = open + 1; cursor < text.size(); ++cursor)
+		{
+			if (auto end = bpp_skip_literal(text, cursor); end != cursor)
+			{
+				cursor = end - 1;
 				continue;
 			}
 
-			if (hdr_line[0] == kMacroPrefix &&
-				hdr_line.find("ifndef") != std::string::npos)
+			if (text[cursor] == '(')
+			{
+				++depth;
+			}
+			else if ((text[cursor] == ',' && depth == 0UL) || (text[cursor] == ')' && depth-- == 0UL))
 			{
-				auto line_after_ifndef =
-					hdr_line.substr(hdr_line.find("ifndef") + strlen("ifndef") + 1);
-				std::string macro;
+				auto value = text.substr(arg, cursor - arg);
+				auto first = std::min(value.size(), value.find_first_not_of(" \t"));
 
-				for (auto& ch : line_after_ifndef)
-				{
-					if (ch == ' ')
-					{
-						break;
-					}
+				value = value.substr(first);
+				args.push_back(value.substr(0, value.find_last_not_of(" \t") + 1));
 
-					macro += ch;
-				}
+				arg = cursor + 1;
 
-				if (macro == "0")
+				if (text[cursor] == ')')
 				{
-					defined		  = true;
-					inactive_code = false;
-					continue;
+					close = cursor;
+					break;
 				}
+			}
+		}
 
-				if (macro == "1")
-				{
-					defined		  = false;
-					inactive_code = true;
+		// the call goes on on the next line, it is left as it is.
+		if (close == std::string_view::npos)
+		{
+			out.append(name);
+			continue;
+		}
 
-					continue;
-				}
+		if (args.size() != macro.fArgs.size())
+			throw std::runtime_error("bpp: " + macro.fName + " expects " + std::to_string(macro.fArgs.size()) + " argument(s).");
+
+		pos = close + 1;
+
+		// arguments are expanded before they replace the parameters, TWICE(TWICE(x)) expands both.
+		std::vector<std::string> expanded_args(args.size());
+
+		for (std::size_t index = 0UL; index < args.size(); ++index)
+			bpp_expand(context, args[index], expanded_args[index], active);
+
+		// the parameters are replaced in one buffer, then the result is expanded again.
+		std::string body;
+
+		for (std::size_t cursor = 0UL; cursor < macro.fValue.size();)
+		{
+			if (auto end = bpp_skip_literal(macro.fValue, cursor); end != cursor)
+			{
+				body.append(macro.fValue, cursor, end - cursor);
+				cursor = end;
+
+				continue;
+			}
+
+			auto param = bpp_identifier(macro.fValue, cursor);
+
+			if (param.empty())
+			{
+				body.push_back(macro.fValue[cursor]);
+				++cursor;
+
+				continue;
+			}
+
+			cursor += param.size();
+
+			auto arg = std::find(macro.fArgs.begin(), macro.fArgs.end(), param);
+
+			if (arg != macro.fArgs.end())
+				body.append(expanded_args[std::distance(macro.fArgs.begin(), arg)]);
+			else
+				body.append(param);
+		}
+
+		active.push_back(&macro);
+		bpp_expand(context, body, out, active);
+		active.pop_back();
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_directive
+// @brief the name of the directive on line, empty if it isn't one.
+// @param rest what follows the name, without the leading blanks.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+std::string_view bpp_directive(std::string_view line, std::string_view& rest)
+{
+	auto pos = line.find_first_not_of(" \t");
+
+	if (pos == std::string_view::npos || line[pos] != kMacroPrefix)
+		return {};
+
+	rest = {};
+	pos	 = line.find_first_not_of(" \t", pos + 1);
+
+	// a lone '#' is the null directive.
+	if (pos == std::string_view::npos || bpp_identifier(line, pos).empty())
+		return "#";
+
+	auto name = bpp_identifier(line, pos);
+
+	rest = line.substr(pos + name.size());
+	rest = rest.substr(std::min(rest.size(), rest.find_first_not_of(" \t")));
+
+	return name;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_lex_condition
+// @brief expand an #if expression and split it into numbers and operators.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+std::vector<Detail::bpp_token> bpp_lex_condition(const Detail::bpp_context& context, std::string_view text)
+{
+	// longest operators first.
+	static const std::string_view kOperators[] = {
+		"<<", ">>", "<=", ">=", "==", "!=", "&&", "||",
+		"+", "-", "*", "/", "%", "<", ">", "&", "|", "^", "!", "~", "?", ":", "(", ")"};
+
+	// defined X and defined(X) are replaced before the macros are expanded.
+	std::string condition;
+
+	for (std::size_t pos = 0UL; pos < text.size();)
+	{
+		if (auto end = bpp_skip_literal(text, pos); end != pos)
+		{
+			condition.append(text.substr(pos, end - pos));
+			pos = end;
+
+			continue;
+		}
+
+		auto name = bpp_identifier(text, pos);
+
+		if (name.empty())
+		{
+			condition.push_back(text[pos]);
+			++pos;
+
+			continue;
+		}
+
+		pos += name.size();
+
+		if (name != "defined")
+		{
+			condition.append(name);
+			continue;
+		}
+
+		pos = std::min(text.size(), text.find_first_not_of(" \t", pos));
+
+		bool paren = pos < text.size() && text[pos] == '(';
+
+		if (paren)
+			pos = std::min(text.size(), text.find_first_not_of(" \t", pos + 1));
+
+		auto macro = pos < text.size() ? bpp_identifier(text, pos) : std::string_view{};
+
+		if (macro.empty())
+			throw std::runtime_error("bpp: defined expects a macro name.");
+
+		pos = std::min(text.size(), text.find_first_not_of(" \t", pos + macro.size()));
+
+		if (paren)
+		{
+			if (pos == text.size() || text[pos] != ')')
+				throw std::runtime_error("bpp: missing ')' after defined.");
+
+			++pos;
+		}
+
+		condition.append(context.fMacros.contains(macro) ? " 1 " : " 0 ");
+	}
+
+	std::string							  expanded;
+	std::vector<const Detail::bpp_macro*> active_macros;
+
+	bpp_expand(context, condition, expanded, active_macros);
+
+	std::vector<Detail::bpp_token> tokens;
+
+	for (std::size_t pos = 0UL; pos < expanded.size();)
+	{
+		if (isspace(expanded[pos]))
+		{
+			++pos;
+			continue;
+		}
+
+		if (isdigit(expanded[pos]))
+		{
+			auto		end = bpp_skip_literal(expanded, pos);
+			std::string number(expanded, pos, end - pos);
+
+			// the u and l suffixes don't change the value.
+			while (!number.empty() && (number.back() == 'u' || number.back() == 'U' || number.back() == 'l' || number.back() == 'L'))
+				number.pop_back();
+
+			char* last = nullptr;
+			auto  base = 0;
+
+			if (number.size() > 2 && number[0] == '0' && (number[1] == 'b' || number[1] == 'B'))
+			{
+				number.erase(0, 2);
+				base = 2;
+			}
 
-				bool found = false;
+			auto value = strtoull(number.c_str(), &last, base);
 
-				defined		  = true;
-				inactive_code = false;
+			if (number.empty() || *last != '\0')
+				throw std::runtime_error("bpp: bad number in #if, " + expanded.substr(pos, end - pos));
 
-				for (auto& macro_ref : kMacros)
+			tokens.push_back({.fValue = static_cast<std::int64_t>(value)});
+			pos = end;
+
+			continue;
+		}
+
+		if (expanded[pos] == '\'')
+		{
+			auto end = bpp_skip_literal(expanded, pos);
+			auto ch	 = pos + 1 < end ? expanded[pos + 1] : '\0';
+
+			if (ch == '\\' && pos + 2 < end)
+			{
+				switch (expanded[pos + 2])
 				{
-					if (hdr_line.find(macro_ref.fName) != std::string::npos)
-					{
-						found = true;
-						break;
-					}
+				case 'n':
+					ch = '\n';
+					break;
+				case 't':
+					ch = '\t';
+					break;
+				case 'r':
+					ch = '\r';
+					break;
+				case '0':
+					ch = '\0';
+					break;
+				default:
+					ch = expanded[pos + 2];
+					break;
 				}
+			}
 
-				if (found)
-				{
-					defined		  = false;
-					inactive_code = true;
+			tokens.push_back({.fValue = ch});
+			pos = end;
 
+			continue;
+		}
+
+		// what is left of the identifiers aren't macros, they are 0.
+		if (auto name = bpp_identifier(expanded, pos); !name.empty())
+		{
+			tokens.push_back({.fValue = name == "true"});
+			pos += name.size();
+
+			continue;
+		}
+
+		auto op = std::find_if(std::begin(kOperators), std::end(kOperators), [&](std::string_view op) {
+			return std::string_view(expanded).substr(pos).starts_with(op);
+		});
+
+		if (op == std::end(kOperators))
+			throw std::runtime_error("bpp: unexpected token in #if, " + expanded.substr(pos));
+
+		tokens.push_back({.fOp = *op});
+		pos += op->size();
+	}
+
+	return tokens;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_eval_binary
+// @brief evaluate the operators binding tighter than precedence, by precedence climbing.
+// @param evaluate false on the side of && || ?: which is short-circuited, it is parsed only.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+std::int64_t bpp_eval_binary(const std::vector<Detail::bpp_token>& tokens, std::size_t& pos, int precedence, bool evaluate);
+
+std::int32_t bpp_precedence(std::string_view op)
+{
+	static const std::pair<std::string_view, std::int32_t> kPrecedence[] = {
+		{"?", 1}, {"||", 2}, {"&&", 3}, {"|", 4}, {"^", 5}, {"&", 6}, {"==", 7}, {"!=", 7}, {"<", 8}, {">", 8}, {"<=", 8}, {">=", 8}, {"<<", 9}, {">>", 9}, {"+", 10}, {"-", 10}, {"*", 11}, {"/", 11}, {"%", 11}};
+
+	for (auto& [name, precedence] : kPrecedence)
+	{
+		if (name == op)
+			return precedence;
+	}
+
+	return 0;
+}
+
+void bpp_expect(const std::vector<Detail::bpp_token>& tokens, std::size_t& pos, std::string_view op)
+{
+	if (pos >= tokens.size() || tokens[pos].fOp != op)
+		throw std::runtime_error("bpp: expected '" + std::string(op) + "' in #if.");
+
+	++pos;
+}
+
+std::int64_t bpp_eval_unary(const std::vector<Detail::bpp_token>& tokens, std::size_t& pos, bool evaluate)
+{
+	if (pos >= tokens.size())
+		throw std::runtime_error("bpp: incomplete #if expression.");
+
+	auto& token = tokens[pos++];
+
+	if (token.fOp.empty())
+		return token.fValue;
+
+	if (token.fOp == "(")
+	{
+		auto value = bpp_eval_binary(tokens, pos, 1, evaluate);
+		bpp_expect(tokens, pos, ")");
+
+		return value;
+	}
+
+	auto value = static_cast<std::uint64_t>(bpp_eval_unary(tokens, pos, evaluate));
+
+	if (token.fOp == "+")
+		return value;
+	if (token.fOp == "-")
+		return -value;
+	if (token.fOp == "!")
+		return !value;
+	if (token.fOp == "~")
+		return ~value;
+
+	throw std::runtime_error("bpp: unexpected '" + std::string(token.fOp) + "' in #if.");
+}
+
+std::int64_t bpp_eval_binary(const std::vector<Detail::bpp_token>& tokens, std::size_t& pos, int precedence, bool evaluate)
+{
+	auto lhs = bpp_eval_unary(tokens, pos, evaluate);
+
+	while (pos < tokens.size())
+	{
+		auto op		 = tokens[pos].fOp;
+		auto op_prec = bpp_precedence(op);
+
+		if (op_prec == 0 || op_prec < precedence)
+			break;
+
+		++pos;
+
+		// the ternary is right associative, and only one of its branches is evaluated.
+		if (op == "?")
+		{
+			auto then_value = bpp_eval_binary(tokens, pos, 1, evaluate && lhs);
+			bpp_expect(tokens, pos, ":");
+			auto else_value = bpp_eval_binary(tokens, pos, op_prec, evaluate && !lhs);
+
+			lhs = lhs ? then_value : else_value;
+			continue;
+		}
+
+		if (op == "&&")
+		{
+			auto rhs = bpp_eval_binary(tokens, pos, op_prec + 1, evaluate && lhs);
+			lhs		 = lhs && rhs;
+
+			continue;
+		}
+
+		if (op == "||")
+		{
+			auto rhs = bpp_eval_binary(tokens, pos, op_prec + 1, evaluate && !lhs);
+			lhs		 = lhs || rhs;
+
+			continue;
+		}
+
+		auto rhs = bpp_eval_binary(tokens, pos, op_prec + 1, evaluate);
+
+		// arithmetic wraps, as it does on uintmax_t.
+		auto lhs_bits = static_cast<std::uint64_t>(lhs);
+		auto rhs_bits = static_cast<std::uint64_t>(rhs);
+
+		if ((op == "/" || op == "%") && rhs == 0)
+		{
+			if (evaluate)
+				throw std::runtime_error("bpp: division by zero in #if.");
+
+			lhs = 0;
+			continue;
+		}
+
+		if (op == "*")
+			lhs = lhs_bits * rhs_bits;
+		else if (op == "/")
+			lhs = rhs == -1 ? -lhs_bits : lhs / rhs;
+		else if (op == "%")
+			lhs = rhs == -1 ? 0 : lhs % rhs;
+		else if (op == "+")
+			lhs = lhs_bits + rhs_bits;
+		else if (op == "-")
+			lhs = lhs_bits - rhs_bits;
+		else if (op == "<<")
+			lhs = rhs < 0 || rhs > 63 ? 0 : lhs_bits << rhs;
+		else if (op == ">>")
+			lhs = lhs >> std::clamp<std::int64_t>(rhs, 0, 63);
+		else if (op == "<")
+			lhs = lhs < rhs;
+		else if (op == ">")
+			lhs = lhs > rhs;
+		else if (op == "<=")
+			lhs = lhs <= rhs;
+		else if (op == ">=")
+			lhs = lhs >= rhs;
+		else if (op == "==")
+			lhs = lhs == rhs;
+		else if (op == "!=")
+			lhs = lhs != rhs;
+		else if (op == "&")
+			lhs = lhs & rhs;
+		else if (op == "^")
+			lhs = lhs ^ rhs;
+		else if (op == "|")
+			lhs = lhs | rhs;
+	}
+
+	return lhs;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_eval_condition
+// @brief evaluate the integer constant expression of an #if or an #elif.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+bool bpp_eval_condition(const Detail::bpp_context& context, std::string_view text)
+{
+	auto		tokens = bpp_lex_condition(context, text);
+	std::size_t pos	   = 0UL;
+
+	if (tokens.empty())
+		throw std::runtime_error("bpp: #if without an expression.");
+
+	auto value = bpp_eval_binary(tokens, pos, 1, true);
+
+	if (pos != tokens.size())
+		throw std::runtime_error("bpp: unexpected '" + std::string(tokens[pos].fOp) + "' in #if.");
+
+	return value != 0;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_parse_file
+// @brief parse file to preprocess it.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+void bpp_parse_file(Detail::bpp_context& context, std::istream& hdr_file, std::ostream& pp_out);
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_include_header
+// @brief parse a header, or replay what it did when it was included in the same state.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+void bpp_include_header(Detail::bpp_context& context, const Detail::bpp_header* header, std::ostream& pp_out)
+{
+	Detail::bpp_header_buf header_buf(header->fContents);
+	std::istream		   header_stream(&header_buf);
+
+	if (kPchDir.empty())
+	{
+		context.fHeaderStack.push_back(header);
+		bpp_parse_file(context, header_stream, pp_out);
+		context.fHeaderStack.pop_back();
+
+		return;
+	}
+
+	auto key   = bpp_header_key(context, header);
+	auto state = bpp_load_header_state(key);
+
+	// a state is stale once a header it read has changed.
+	for (std::size_t depend = 0UL; state && depend < state->fDepends.size(); ++depend)
+	{
+		auto& [path, hash] = state->fDepends[depend];
+		auto  depend_header = bpp_read_header(path);
+
+		if (!depend_header || depend_header->fHash != hash)
+			state = nullptr;
+	}
+
+	if (state)
+	{
+		pp_out << state->fText;
+
+		for (auto& macro : state->fMacros)
+			bpp_define(context, macro);
+
+		for (auto& line : state->fIncludes)
+			bpp_add_include(context, line);
+
+		for (auto& path : state->fOnce)
+			bpp_mark_once(context, bpp_read_header(path));
+
+		for (auto& [path, hash] : state->fDepends)
+			bpp_add_depend(context, path, hash);
+
+		return;
+	}
+
+	state = std::make_shared<Detail::bpp_header_state>();
+
+	std::ostringstream text;
+
+	context.fRecording.push_back(state.get());
+	context.fHeaderStack.push_back(header);
+
+	try
+	{
+		bpp_parse_file(context, header_stream, text);
+	}
+	catch (...)
+	{
+		context.fHeaderStack.pop_back();
+		context.fRecording.pop_back();
+
+		throw;
+	}
+
+	context.fHeaderStack.pop_back();
+	context.fRecording.pop_back();
+
+	state->fText = text.str();
+	pp_out << state->fText;
+
+	bpp_save_header_state(key, state);
+}
+
+void bpp_parse_file(Detail::bpp_context& context, std::istream& hdr_file, std::ostream& pp_out)
+{
+	std::string hdr_line;
+	std::string line_after_include;
+
+	// the #if blocks we are in, the innermost last.
+	std::vector<Detail::bpp_conditional> conditionals;
+
+	bool in_comment = false;
+
+	// lines are expanded in the same buffer.
+	std::string							  expanded;
+	std::vector<const Detail::bpp_macro*> active_macros;
+
+	try
+	{
+		while (std::getline(hdr_file, hdr_line))
+		{
+			bool active = conditionals.empty() || conditionals.back().fActive;
+
+			// the end of a block comment opened on a previous line.
+			bool block_comment = in_comment;
+
+			if (in_comment)
+			{
+				if (hdr_line.find("*/") == std::string::npos)
 					continue;
-				}
+
+				hdr_line.erase(0, hdr_line.find("*/") + strlen("*/"));
+				in_comment = false;
 			}
-			else if (hdr_line[0] == kMacroPrefix &&
-					 hdr_line.find("else") != std::string::npos)
+
+			std::string_view rest;
+
+			// inside a block that is skipped, only the directives are looked at.
+			if (!active && bpp_directive(hdr_line, rest).empty())
+				continue;
+
+			if (hdr_line.find("--/") != std::string::npos)
 			{
-				if (!defined && inactive_code)
-				{
-					inactive_code = false;
-					defined		  = true;
+				hdr_line.erase(hdr_line.find("--/"));
+			}
 
-					continue;
+			if (hdr_line.find("--*") != std::string::npos)
+			{
+				auto begin = hdr_line.find("--*");
+				auto end   = hdr_line.find("*/", begin + strlen("--*"));
+
+				block_comment = true;
+
+				// get rid of comment, it may end on another line.
+				if (end == std::string::npos)
+				{
+					in_comment = true;
+					hdr_line.erase(begin);
 				}
 				else
 				{
-					defined		  = false;
-					inactive_code = true;
-
-					continue;
+					hdr_line.erase(begin, end + strlen("*/") - begin);
 				}
 			}
-			else if (hdr_line[0] == kMacroPrefix &&
-					 hdr_line.find("ifdef") != std::string::npos)
+
+			/// BPP 'brief' documentation.
+			if (hdr_line.find("@brief") != std::string::npos)
 			{
-				auto line_after_ifdef =
-					hdr_line.substr(hdr_line.find("ifdef") + strlen("ifdef") + 1);
-				std::string macro;
+				hdr_line.erase(hdr_line.find("@brief"));
 
-				for (auto& ch : line_after_ifdef)
-				{
-					if (ch == ' ')
-					{
-						break;
-					}
+				// TODO: Write an <file_name>.html or append to it.
+			}
+
+			auto directive = bpp_directive(hdr_line, rest);
 
-					macro += ch;
+			if (directive == "if" || directive == "ifdef" || directive == "ifndef")
+			{
+				Detail::bpp_conditional conditional;
+
+				conditional.fParentActive = active;
+
+				if (active && directive == "if")
+				{
+					conditional.fActive = bpp_eval_condition(context, rest);
 				}
+				else if (active)
+				{
+					if (rest.empty() || bpp_identifier(rest, 0).empty())
+						throw std::runtime_error("bpp: #" + std::string(directive) + " expects a macro name.");
 
-				if (macro == "0")
+					conditional.fActive = context.fMacros.contains(bpp_identifier(rest, 0)) == (directive == "ifdef");
+				}
+				else
 				{
-					defined		  = false;
-					inactive_code = true;
+					conditional.fActive = false;
+				}
+
+				conditional.fTaken = conditional.fActive;
+				conditionals.push_back(conditional);
+
+				continue;
+			}
 
+			if (directive == "elif" || directive == "else" || directive == "endif")
+			{
+				if (conditionals.empty())
+					throw std::runtime_error("bpp: #" + std::string(directive) + " without #if.");
+
+				if (directive == "endif")
+				{
+					conditionals.pop_back();
 					continue;
 				}
 
-				if (macro == "1")
-				{
-					defined		  = true;
-					inactive_code = false;
+				auto& conditional = conditionals.back();
+
+				if (conditional.fElse)
+					throw std::runtime_error("bpp: #" + std::string(directive) + " after #else.");
+
+				conditional.fElse = directive == "else";
+
+				// a branch is only evaluated when none of the previous ones were taken.
+				if (!conditional.fParentActive || conditional.fTaken)
+					conditional.fActive = false;
+				else
+					conditional.fActive = conditional.fElse || bpp_eval_condition(context, rest);
 
+				conditional.fTaken |= conditional.fActive;
+
+				continue;
+			}
+
+			if (!active)
+				continue;
+
+			if (directive.empty())
+			{
+				// what is left of a line with a block comment, if anything.
+				if (block_comment && hdr_line.find_first_not_of(" \t") == std::string::npos)
 					continue;
-				}
 
-				defined		  = false;
-				inactive_code = true;
+				expanded.clear();
+				bpp_expand(context, hdr_line, expanded, active_macros);
 
-				for (auto& macro_ref : kMacros)
-				{
-					if (hdr_line.find(macro_ref.fName) != std::string::npos)
-					{
-						defined		  = true;
-						inactive_code = false;
+				pp_out << expanded << std::endl;
 
-						break;
-					}
-				}
+				continue;
 			}
-			else if (hdr_line[0] == kMacroPrefix &&
-					 hdr_line.find("if") != std::string::npos)
+
+			if (directive == "define")
 			{
-				inactive_code = true;
+				auto line_after_define = std::string(rest);
 
-				std::vector<Detail::bpp_macro_condition> bpp_macro_condition_list = {
-					{
-						.fType	   = Detail::kEqual,
-						.fTypeName = "==",
-					},
-					{
-						.fType	   = Detail::kNotEqual,
-						.fTypeName = "!=",
-					},
-					{
-						.fType	   = Detail::kLesserThan,
-						.fTypeName = "<",
-					},
-					{
-						.fType	   = Detail::kGreaterThan,
-						.fTypeName = ">",
-					},
-					{
-						.fType	   = Detail::kLesserEqThan,
-						.fTypeName = "<=",
-					},
-					{
-						.fType	   = Detail::kGreaterEqThan,
-						.fTypeName = ">=",
-					},
-				};
+				std::string macro_value;
+				std::string macro_key;
 
-				int32_t good_to_go = 0;
+				std::size_t pos = 0UL;
+
+				std::vector<std::string> args;
+				bool					 on_args = false;
 
-				for (auto& macro_condition : bpp_macro_condition_list)
+				for (auto& ch : line_after_define)
 				{
-					if (hdr_line.find(macro_condition.fTypeName) != std::string::npos)
-					{
-						for (auto& found_macro : kMacros)
-						{
-							if (hdr_line.find(found_macro.fName) != std::string::npos)
-							{
-								good_to_go =
-									bpp_parse_if_condition(macro_condition, found_macro,
-														   inactive_code, defined, hdr_line);
+					++pos;
 
-								break;
-							}
-						}
+					if (ch == '(')
+					{
+						on_args = true;
+						continue;
+					}
+
+					if (ch == ')')
+					{
+						on_args = false;
+						continue;
 					}
-				}
 
-				if (good_to_go)
-					continue;
+					if (ch == '\\')
+						continue;
 
-				auto line_after_if =
-					hdr_line.substr(hdr_line.find("if") + strlen("if") + 1);
-				std::string macro;
+					if (on_args)
+						continue;
 
-				for (auto& ch : line_after_if)
-				{
 					if (ch == ' ')
 					{
+						for (size_t i = pos; i < line_after_define.size(); i++)
+						{
+							macro_value += line_after_define[i];
+						}
+
 						break;
 					}
 
-					macro += ch;
+					macro_key += ch;
 				}
 
-				if (macro == "0")
-				{
-					defined		  = false;
-					inactive_code = true;
-					continue;
-				}
+				std::string str;
 
-				if (macro == "1")
+				// a function-like macro has its parameters right after its name.
+				if (line_after_define.size() > macro_key.size() && line_after_define[macro_key.size()] == '(')
 				{
-					defined		  = true;
-					inactive_code = false;
+					for (auto& subc : line_after_define.substr(macro_key.size() + 1))
+					{
+						if (subc == ' ' || subc == '\t')
+							continue;
 
-					continue;
-				}
+						if (subc == ',' || subc == ')')
+						{
+							if (!str.empty())
+								args.push_back(str);
 
-				// last try, is it defined to be one?
-				for (auto& macro_ref : kMacros)
-				{
-					if (macro_ref.fName.find(macro) != std::string::npos &&
-						macro_ref.fValue == "1")
-					{
-						inactive_code = false;
-						defined		  = true;
+							str.clear();
 
-						break;
+							if (subc == ')')
+								break;
+
+							continue;
+						}
+
+						str.push_back(subc);
 					}
 				}
+
+				Detail::bpp_macro macro;
+
+				macro.fArgs	 = args;
+				macro.fName	 = macro_key;
+				macro.fValue = macro_value;
+
+				bpp_define(context, std::move(macro));
 			}
-			else if (hdr_line[0] == kMacroPrefix &&
-					 hdr_line.find("warning") != std::string::npos)
+			else if (directive == "warning")
 			{
-				auto line_after_warning =
-					hdr_line.substr(hdr_line.find("warning") + strlen("warning") + 1);
 				std::string message;
 
-				for (auto& ch : line_after_warning)
+				for (auto& ch : rest)
 				{
 					if (ch == '\r' || ch == '\n')
 					{
@@ -774,14 +1577,11 @@ void bpp_parse_file(std::ifstream& hdr_file, std::ofstream& pp_out)
 
 				std::cout << "warn: " << message << std::endl;
 			}
-			else if (hdr_line[0] == kMacroPrefix &&
-					 hdr_line.find("error") != std::string::npos)
+			else if (directive == "error")
 			{
-				auto line_after_warning =
-					hdr_line.substr(hdr_line.find("error") + strlen("error") + 1);
 				std::string message;
 
-				for (auto& ch : line_after_warning)
+				for (auto& ch : rest)
 				{
 					if (ch == '\r' || ch == '\n')
 					{
@@ -793,24 +1593,21 @@ void bpp_parse_file(std::ifstream& hdr_file, std::ofstream& pp_out)
 
 				throw std::runtime_error("error: " + message);
 			}
-			else if (hdr_line[0] == kMacroPrefix &&
-					 hdr_line.find("include ") != std::string::npos)
+			else if (directive == "include")
 			{
-				line_after_include =
-					hdr_line.substr(hdr_line.find("include ") + strlen("include "));
+				line_after_include = rest;
 
-			kIncludeFile:
-				auto it = std::find(kAllIncludes.cbegin(), kAllIncludes.cend(),
+				auto it = std::find(context.fAllIncludes.cbegin(), context.fAllIncludes.cend(),
 									line_after_include);
 
-				if (it != kAllIncludes.cend())
+				if (it != context.fAllIncludes.cend())
 				{
 					continue;
 				}
 
 				std::string path;
 
-				kAllIncludes.push_back(line_after_include);
+				bpp_add_include(context, line_after_include);
 
 				bool enable	   = false;
 				bool not_local = false;
@@ -841,54 +1638,42 @@ void bpp_parse_file(std::ifstream& hdr_file, std::ofstream& pp_out)
 					}
 				}
 
-				if (not_local)
+				if (path.ends_with('>'))
 				{
-					bool open = false;
-
-					if (path.ends_with('>'))
-					{
-						path.erase(path.find('>'));
-					}
-
-					if (path.ends_with('"'))
-					{
-						path.erase(path.find('"'));
-					}
-
-					for (auto& include : kIncludes)
-					{
-						std::string header_path = include;
-						header_path.push_back('-');
-						header_path += path;
-
-						std::ifstream header(header_path);
-
-						if (!header.is_open())
-							continue;
-
-						open = true;
+					path.erase(path.find('>'));
+				}
 
-						bpp_parse_file(header, pp_out);
+				if (path.ends_with('"'))
+				{
+					path.erase(path.find('"'));
+				}
 
-						break;
-					}
+				auto& resolved = bpp_resolve_include(path, not_local);
+				auto  header   = resolved.empty() ? nullptr : bpp_read_header(resolved);
 
-					if (!open)
-					{
-						throw std::runtime_error("bpp: no such include file: " + path);
-					}
-				}
-				else
+				if (!header)
 				{
-					std::ifstream header(path);
+					throw std::runtime_error("bpp: no such include file: " + path);
+				}
 
-					if (!header.is_open())
-						throw std::runtime_error("bpp: no such include file: " + path);
+				bpp_add_depend(context, header->fPath, header->fHash);
 
-					bpp_parse_file(header, pp_out);
+				// a header with #pragma once, or whose guard is defined, isn't read again.
+				if (context.fOnce.contains(header) ||
+					(!header->fGuard.empty() &&
+					 context.fMacros.contains(header->fGuard)))
+				{
+					continue;
 				}
+
+				bpp_include_header(context, header, pp_out);
 			}
-			else
+			else if (directive == "pragma" && rest.starts_with("once"))
+			{
+				if (!context.fHeaderStack.empty())
+					bpp_mark_once(context, context.fHeaderStack.back());
+			}
+			else if (directive != "#")
 			{
 				std::cerr << ("bpp: unknown pre-processor directive, " + hdr_line)
 						  << "\n";
@@ -900,71 +1685,360 @@ void bpp_parse_file(std::ifstream& hdr_file, std::ofstream& pp_out)
 	{
 		return;
 	}
+
+	if (!conditionals.empty())
+		throw std::runtime_error("bpp: unterminated #if.");
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
-// @brief main entrypoint of app.
+// @name bpp_define_builtins
+// @brief define the builtin macros, every translation unit starts with them.
 
 /////////////////////////////////////////////////////////////////////////////////////////
 
-LIBCOMPILER_MODULE(CPlusPlusPreprocessorMain)
+void bpp_define_builtins()
+{
+	Detail::bpp_macro macro_1;
+
+	macro_1.fName  = "__true";
+	macro_1.fValue = "1";
+
+	kMacros[macro_1.fName] = macro_1;
+
+	Detail::bpp_macro macro_unreachable;
+
+	macro_unreachable.fName	 = "__unreachable";
+	macro_unreachable.fValue = "__libcompiler_unreachable";
+
+	kMacros[macro_unreachable.fName] = macro_unreachable;
+
+	Detail::bpp_macro macro_0;
+
+	macro_0.fName  = "__false";
+	macro_0.fValue = "0";
+
+	kMacros[macro_0.fName] = macro_0;
+
+	Detail::bpp_macro macro_zka;
+
+	macro_zka.fName	 = "__LIBCOMPILER__";
+	macro_zka.fValue = "1";
+
+	kMacros[macro_zka.fName] = macro_zka;
+
+	Detail::bpp_macro macro_cxx;
+
+	macro_cxx.fName	 = "__cplusplus";
+	macro_cxx.fValue = "202302L";
+
+	kMacros[macro_cxx.fName] = macro_cxx;
+
+	Detail::bpp_macro macro_size_t;
+	macro_size_t.fName	= "__SIZE_TYPE__";
+	macro_size_t.fValue = "unsigned long long int";
+
+	kMacros[macro_size_t.fName] = macro_size_t;
+
+	macro_size_t.fName	= "__UINT32_TYPE__";
+	macro_size_t.fValue = "unsigned int";
+
+	kMacros[macro_size_t.fName] = macro_size_t;
+
+	macro_size_t.fName	= "__UINTPTR_TYPE__";
+	macro_size_t.fValue = "unsigned int";
+
+	kMacros[macro_size_t.fName] = macro_size_t;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_hash_config
+// @brief sum up the command line macros and the include dirs, once they are all known.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+void bpp_hash_config()
+{
+	// a kept header state is only valid where its includes resolve the same way.
+	kConfigState = 0UL;
+
+	for (auto& include : kIncludes)
+		kConfigState = bpp_hash(include, bpp_hash({"", 1}, kConfigState));
+
+	kConfigState = bpp_hash(std::filesystem::current_path().string(), kConfigState);
+	kMacroState	 = 0UL;
+
+	for (auto& [name, macro] : kMacros)
+		kMacroState += bpp_hash_macro(macro);
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_preprocess
+// @brief preprocess a file in its own context.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+bool bpp_preprocess(const std::string& file, std::ostream& pp_out, Detail::bpp_depends* depends = nullptr)
 {
+	Detail::bpp_context context;
+
+	context.fMacros		= kMacros;
+	context.fMacroState = kMacroState;
+
 	try
 	{
-		bool skip		 = false;
-		bool double_skip = false;
+		std::ifstream file_descriptor(file);
+
+		bpp_parse_file(context, file_descriptor, pp_out);
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cout << e.what() << '\n';
+		return false;
+	}
+
+	if (!depends)
+		return true;
+
+	// a guarded header is found on every include of it, it is listed once.
+	std::unordered_set<std::string_view> seen;
+
+	for (auto& depend : context.fDepends)
+	{
+		if (seen.insert(depend.first).second)
+			depends->push_back(depend);
+	}
+
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_deps_rule
+// @brief the make rule of target, for --bpp:deps.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+std::string bpp_deps_rule(const std::string& target, const Detail::bpp_depends& depends)
+{
+	// make and ninja read a blank, a '#' and a '$' escaped.
+	auto escape = [](std::string_view path) {
+		std::string escaped;
+
+		for (auto ch : path)
+		{
+			if (ch == ' ' || ch == '#')
+				escaped.push_back('\\');
+			else if (ch == '$')
+				escaped.push_back('$');
+
+			escaped.push_back(ch);
+		}
+
+		return escaped;
+	};
+
+	std::string rule = escape(target) + ":";
+
+	for (auto& [path, hash] : depends)
+		rule += (&path == &depends.front().first ? " " : " \\\n ") + escape(path);
+
+	return rule + "\n";
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_save_stamp
+// @brief remember what file + ".pp" was made of, for --bpp:skip-unchanged.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+void bpp_save_stamp(const std::string& file, const Detail::bpp_depends& depends)
+{
+	std::string out = kStampMagic;
+
+	bpp_put_u64(out, kStampVersion);
+	bpp_put_u64(out, kConfigState);
+	bpp_put_u64(out, kMacroState);
+	bpp_put_u64(out, depends.size());
+
+	for (auto& [path, hash] : depends)
+	{
+		bpp_put_string(out, path);
+		bpp_put_u64(out, hash);
+	}
+
+	std::ofstream stamp(file + ".pp" kStampExt, std::ofstream::binary | std::ofstream::trunc);
+	stamp.write(out.data(), out.size());
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_up_to_date
+// @brief is file + ".pp" newer than what it was made of, or made of the same contents?
+// @param depends what it was made of, read from its stamp.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+bool bpp_up_to_date(const std::string& file, Detail::bpp_depends& depends)
+{
+	auto		  pp_path = file + ".pp";
+	std::ifstream stamp(pp_path + kStampExt, std::ifstream::binary | std::ifstream::ate);
+
+	if (!stamp.is_open() || !std::filesystem::exists(pp_path))
+		return false;
+
+	std::string contents(stamp.tellg(), 0);
+	stamp.seekg(0);
+
+	if (!stamp.read(contents.data(), contents.size()) || !contents.starts_with(kStampMagic))
+		return false;
+
+	auto in = std::string_view(contents).substr(strlen(kStampMagic));
+
+	std::uint64_t version = 0UL, config = 0UL, macros = 0UL, count = 0UL;
+
+	// the macros or the include dirs of the command line changed.
+	if (!bpp_get_u64(in, version) || version != kStampVersion || !bpp_get_u64(in, config) || config != kConfigState ||
+		!bpp_get_u64(in, macros) || macros != kMacroState || !bpp_get_u64(in, count))
+		return false;
+
+	for (; count > 0UL; --count)
+	{
+		auto& [path, hash] = depends.emplace_back();
+
+		if (!bpp_get_string(in, path) || !bpp_get_u64(in, hash))
+			return false;
+	}
+
+	std::error_code ec;
+
+	auto pp_time = std::filesystem::last_write_time(pp_path, ec);
+	bool touched = false;
+
+	if (ec)
+		return false;
+
+	for (auto& [path, hash] : depends)
+	{
+		auto time = std::filesystem::last_write_time(path, ec);
+
+		if (ec)
+			return false;
+
+		if (time <= pp_time)
+			continue;
+
+		// newer, its contents tell whether it changed.
+		auto header = bpp_read_header(path);
+
+		if (!header || header->fHash != hash)
+			return false;
+
+		touched = true;
+	}
+
+	// the .pp is as new as what it was made of, the next run only compares times.
+	if (touched)
+		std::filesystem::last_write_time(pp_path, std::filesystem::file_time_type::clock::now(), ec);
+
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+// @name bpp_preprocess_file
+// @brief preprocess a file, to file + ".pp".
+// @param rule its make rule, for --bpp:deps.
+
+/////////////////////////////////////////////////////////////////////////////////////////
+
+bool bpp_preprocess_file(const std::string& file, std::string& rule)
+{
+	if (!std::filesystem::exists(file))
+		return true;
 
-		Detail::bpp_macro macro_1;
+	Detail::bpp_depends depends;
+
+	if (kSkipUnchanged && bpp_up_to_date(file, depends))
+	{
+		rule = bpp_deps_rule(file + ".pp", depends);
+		return true;
+	}
+
+	depends.clear();
+
+	auto input = kSkipUnchanged ? bpp_read_header(file) : nullptr;
+
+	depends.emplace_back(file, input ? input->fHash : 0UL);
+
+	{
+		std::ofstream file_descriptor_pp(file + ".pp");
 
-		macro_1.fName  = "__true";
-		macro_1.fValue = "1";
+		if (!bpp_preprocess(file, file_descriptor_pp, &depends))
+		{
+			// the .pp is incomplete, it is made again next time.
+			std::error_code ec;
+			std::filesystem::remove(file + ".pp" kStampExt, ec);
 
-		kMacros.push_back(macro_1);
+			return false;
+		}
+	}
 
-		Detail::bpp_macro macro_unreachable;
+	if (kSkipUnchanged)
+		bpp_save_stamp(file, depends);
 
-		macro_unreachable.fName	 = "__unreachable";
-		macro_unreachable.fValue = "__libcompiler_unreachable";
+	rule = bpp_deps_rule(file + ".pp", depends);
 
-		kMacros.push_back(macro_unreachable);
+	return true;
+}
 
-		Detail::bpp_macro macro_0;
+/////////////////////////////////////////////////////////////////////////////////////////
 
-		macro_0.fName  = "__false";
-		macro_0.fValue = "0";
+// @brief pipeline entrypoint, preprocess a file line by line into out.
 
-		kMacros.push_back(macro_0);
+/////////////////////////////////////////////////////////////////////////////////////////
 
-		Detail::bpp_macro macro_zka;
+LC_IMPORT_C int CPlusPlusPreprocessorPipe(const char* file, LibCompiler::LinePipe* out)
+{
+	if (!std::filesystem::exists(file))
+	{
+		std::cout << "bpp: no such file: " << file << '\n';
+		out->Close();
 
-		macro_zka.fName	 = "__LIBCOMPILER__";
-		macro_zka.fValue = "1";
+		return 1;
+	}
 
-		kMacros.push_back(macro_zka);
+	bpp_define_builtins();
+	bpp_hash_config();
 
-		Detail::bpp_macro macro_cxx;
+	LibCompiler::LinePipeWriter writer(*out);
+	std::ostream				pp_out(&writer);
 
-		macro_cxx.fName	 = "__cplusplus";
-		macro_cxx.fValue = "202302L";
+	auto ok = bpp_preprocess(file, pp_out);
 
-		kMacros.push_back(macro_cxx);
+	writer.Flush();
+	out->Close();
 
-		Detail::bpp_macro macro_size_t;
-		macro_size_t.fName	= "__SIZE_TYPE__";
-		macro_size_t.fValue = "unsigned long long int";
+	return ok ? 0 : 1;
+}
 
-		kMacros.push_back(macro_size_t);
+/////////////////////////////////////////////////////////////////////////////////////////
 
-		macro_size_t.fName	= "__UINT32_TYPE__";
-		macro_size_t.fValue = "unsigned int";
+// @brief main entrypoint of app.
 
-		kMacros.push_back(macro_size_t);
+/////////////////////////////////////////////////////////////////////////////////////////
 
-		macro_size_t.fName	= "__UINTPTR_TYPE__";
-		macro_size_t.fValue = "unsigned int";
+LIBCOMPILER_MODULE(CPlusPlusPreprocessorMain)
+{
+	try
+	{
+		bool skip		 = false;
+		bool double_skip = false;
 
-		kMacros.push_back(macro_size_t);
+		bpp_define_builtins();
 
 		for (auto index = 1UL; index < argc; ++index)
 		{
@@ -995,6 +2069,10 @@ LIBCOMPILER_MODULE(CPlusPlusPreprocessorMain)
 					printf("%s\n", "--bpp:working-dir <path>: set directory to working path.");
 					printf("%s\n", "--bpp:include-dir <path>: add directory to include path.");
 					printf("%s\n", "--bpp:def <name> <value>: define a macro.");
+					printf("%s\n", "--bpp:pch-dir <path>: keep preprocessed headers in this directory.");
+					printf("%s\n", "--bpp:jobs <n>: preprocess n files at once.");
+					printf("%s\n", "--bpp:deps <file>: write the headers of each file as make rules.");
+					printf("%s\n", "--bpp:skip-unchanged: keep a .pp when its file and headers didn't change.");
 					printf("%s\n", "--bpp:ver: print the version.");
 					printf("%s\n", "--bpp:?: show help (this current command).");
 
@@ -1017,6 +2095,32 @@ LIBCOMPILER_MODULE(CPlusPlusPreprocessorMain)
 					kWorkingDir		= inc;
 				}
 
+				if (strcmp(argv[index], "--bpp:jobs") == 0 && argv[index + 1] != nullptr)
+				{
+					kJobs = std::max(1UL, strtoul(argv[index + 1], nullptr, 10));
+					skip  = true;
+				}
+
+				if (strcmp(argv[index], "--bpp:deps") == 0 && argv[index + 1] != nullptr)
+				{
+					kDepsFile = argv[index + 1];
+					skip	  = true;
+				}
+
+				if (strcmp(argv[index], "--bpp:skip-unchanged") == 0)
+				{
+					kSkipUnchanged = true;
+				}
+
+				if (strcmp(argv[index], "--bpp:pch-dir") == 0 && argv[index + 1] != nullptr)
+				{
+					kPchDir = argv[index + 1];
+					skip	= true;
+
+					std::error_code ec;
+					std::filesystem::create_directories(kPchDir, ec);
+				}
+
 				if (strcmp(argv[index], "--bpp:def") == 0 && argv[index + 1] != nullptr &&
 					argv[index + 2] != nullptr)
 				{
@@ -1046,7 +2150,7 @@ LIBCOMPILER_MODULE(CPlusPlusPreprocessorMain)
 					macro.fName	 = macro_key;
 					macro.fValue = macro_value;
 
-					kMacros.push_back(macro);
+					kMacros[macro.fName] = macro;
 
 					double_skip = true;
 				}
@@ -1060,15 +2164,48 @@ LIBCOMPILER_MODULE(CPlusPlusPreprocessorMain)
 		if (kFiles.empty())
 			return LIBCOMPILER_EXEC_ERROR;
 
-		for (auto& file : kFiles)
+		bpp_hash_config();
+
+		// files are handed out one by one, nothing new starts after an error.
+		std::atomic<std::size_t> next_file = 0UL;
+		std::atomic<bool>		 failed	   = false;
+
+		// the rules are written in the order of the files.
+		std::vector<std::string> rules(kFiles.size());
+
+		auto worker = [&]() {
+			for (auto file = next_file++; file < kFiles.size() && !failed; file = next_file++)
+			{
+				if (!bpp_preprocess_file(kFiles[file], rules[file]))
+					failed = true;
+			}
+		};
+
+		std::vector<std::thread> workers;
+
+		for (auto job = 1UL; job < std::min(kJobs, kFiles.size()); ++job)
+			workers.emplace_back(worker);
+
+		worker();
+
+		for (auto& thread : workers)
+			thread.join();
+
+		if (failed)
+			return 1;
+
+		if (!kDepsFile.empty())
 		{
-			if (!std::filesystem::exists(file))
-				continue;
+			std::ofstream deps(kDepsFile, std::ofstream::trunc);
 
-			std::ifstream file_descriptor(file);
-			std::ofstream file_descriptor_pp(file + ".pp");
+			for (auto& rule : rules)
+				deps << rule;
 
-			bpp_parse_file(file_descriptor, file_descriptor_pp);
+			if (!deps.good())
+			{
+				std::cout << "bpp: can't write " << kDepsFile << '\n';
+				return 1;
+			}
 		}
 
 		return 0;
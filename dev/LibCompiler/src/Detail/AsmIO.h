@@ -0,0 +1,526 @@
+/* -------------------------------------------
+
+	Copyright (C) 2024-2025 Amlal EL Mahrous, all rights reserved
+
+------------------------------------------- */
+
+#pragma once
+
+#include <LibCompiler/AE.h>
+#include <LibCompiler/LinePipe.h>
+#include <LibCompiler/PEF.h>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <string_view>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+/// @file AsmIO.h
+/// @brief Assembler I/O layer, sources are mapped, sections are buffered and objects are written in one go.
+
+namespace Detail
+{
+	/// @brief A memory mapped assembler source, walked line by line.
+	class AsmSourceFile final
+	{
+	public:
+		explicit AsmSourceFile(const std::string& path)
+		{
+			fFd = ::open(path.c_str(), O_RDONLY);
+
+			if (fFd < 0)
+				return;
+
+			struct stat st;
+
+			if (::fstat(fFd, &st) != 0)
+			{
+				this->Close();
+				return;
+			}
+
+			fSize = st.st_size;
+
+			// an empty source has nothing to map, but it is still a valid source.
+			if (fSize == 0)
+				return;
+
+			void* data = ::mmap(nullptr, fSize, PROT_READ, MAP_PRIVATE, fFd, 0);
+
+			if (data == MAP_FAILED)
+			{
+				this->Close();
+				return;
+			}
+
+			::madvise(data, fSize, MADV_SEQUENTIAL);
+
+			fData = static_cast<const char*>(data);
+		}
+
+		~AsmSourceFile()
+		{
+			this->Close();
+		}
+
+		AsmSourceFile& operator=(const AsmSourceFile&) = delete;
+		AsmSourceFile(const AsmSourceFile&)			   = delete;
+
+	public:
+		bool IsOpen() const noexcept
+		{
+			return fFd >= 0;
+		}
+
+		/// @brief Fetch the next line, like std::getline it doesn't include the new line.
+		/// @param line the line, it points into the mapping.
+		/// @return false when the end of the source is reached.
+		bool ReadLine(std::string_view& line) noexcept
+		{
+			if (fCursor >= fSize)
+				return false;
+
+			const char* start = fData + fCursor;
+			const char* end	  = static_cast<const char*>(std::memchr(start, '\n', fSize - fCursor));
+
+			if (!end)
+				end = fData + fSize;
+
+			line = std::string_view(start, end - start);
+			fCursor += line.size() + 1;
+
+			return true;
+		}
+
+		/// @brief Walk the source again from its first line, for another pass.
+		void Rewind() noexcept
+		{
+			fCursor = 0UL;
+		}
+
+	private:
+		void Close() noexcept
+		{
+			if (fData)
+				::munmap(const_cast<char*>(fData), fSize);
+
+			if (fFd >= 0)
+				::close(fFd);
+
+			fData = nullptr;
+			fFd	  = -1;
+			fSize = 0UL;
+		}
+
+	private:
+		int			fFd{-1};
+		const char* fData{nullptr};
+		std::size_t fSize{0UL};
+		std::size_t fCursor{0UL};
+	};
+
+	/// @brief An assembler source streamed by the previous stage of the pipeline, walked once.
+	class AsmSourcePipe final
+	{
+	public:
+		explicit AsmSourcePipe(LibCompiler::LinePipe& pipe)
+			: fPipe(pipe)
+		{
+		}
+
+		~AsmSourcePipe() = default;
+
+		AsmSourcePipe& operator=(const AsmSourcePipe&) = delete;
+		AsmSourcePipe(const AsmSourcePipe&)			   = delete;
+
+	public:
+		bool IsOpen() const noexcept
+		{
+			return true;
+		}
+
+		/// @brief Fetch the next line, waiting for the previous stage to produce it.
+		/// @param line the line, valid until the next call.
+		/// @return false when the previous stage is done.
+		bool ReadLine(std::string_view& line)
+		{
+			if (!fPipe.Pop(fLine))
+				return false;
+
+			line = fLine;
+
+			return true;
+		}
+
+	private:
+		LibCompiler::LinePipe& fPipe;
+		std::string			   fLine;
+	};
+
+	/// @brief A typed section of an object, there is one per record.
+	/// @note code and data are materialized byte for byte, zero (bss) sections are only sized.
+	class AsmSectionBuffer final
+	{
+	public:
+		explicit AsmSectionBuffer(Int32 kind = LibCompiler::kPefCode)
+			: fKind(kind)
+		{
+		}
+
+		~AsmSectionBuffer() = default;
+
+		AsmSectionBuffer& operator=(const AsmSectionBuffer&) = default;
+		AsmSectionBuffer(const AsmSectionBuffer&)			 = default;
+
+		AsmSectionBuffer& operator=(AsmSectionBuffer&&) = default;
+		AsmSectionBuffer(AsmSectionBuffer&&)			= default;
+
+	public:
+		Int32 Kind() const noexcept
+		{
+			return fKind;
+		}
+
+		bool IsZero() const noexcept
+		{
+			return fKind == LibCompiler::kPefZero;
+		}
+
+		void Reserve(std::size_t size)
+		{
+			if (!this->IsZero())
+				fBytes.reserve(size);
+		}
+
+		void Append(std::uint8_t byte)
+		{
+			fSize += sizeof(byte);
+
+			if (!this->IsZero())
+				fBytes.push_back(byte);
+		}
+
+		void Append(const void* data, std::size_t size)
+		{
+			fSize += size;
+
+			if (!this->IsZero())
+			{
+				auto bytes = static_cast<const std::uint8_t*>(data);
+				fBytes.insert(fBytes.end(), bytes, bytes + size);
+			}
+		}
+
+		/// @brief Overwrite bytes already appended, a zero section stays zero.
+		void Patch(std::size_t offset, const void* data, std::size_t size)
+		{
+			if (!this->IsZero() && offset + size <= fBytes.size())
+				std::memcpy(fBytes.data() + offset, data, size);
+		}
+
+		/// @brief Read a byte already appended, zero sections always read as zero.
+		std::uint8_t At(std::size_t offset) const noexcept
+		{
+			return offset < fBytes.size() ? fBytes[offset] : 0;
+		}
+
+		/// @brief Size of the section in memory.
+		std::size_t Size() const noexcept
+		{
+			return fSize;
+		}
+
+		/// @brief Size of the section on disk, zero for a bss section.
+		std::size_t FileSize() const noexcept
+		{
+			return fBytes.size();
+		}
+
+		const std::uint8_t* Data() const noexcept
+		{
+			return fBytes.data();
+		}
+
+	private:
+		Int32					  fKind{LibCompiler::kPefCode};
+		std::size_t				  fSize{0UL};
+		std::vector<std::uint8_t> fBytes;
+	};
+
+	/// @brief Close the section of the previous record, and open the one of the next record.
+	/// @param records the records emitted so far, the last one gets the size of its section.
+	/// @param sections the closed sections, in record order.
+	/// @param current the section being emitted.
+	/// @param kind the kind of the next record.
+	inline void asm_open_section(std::vector<LibCompiler::AERecordHeader>& records,
+								 std::vector<AsmSectionBuffer>& sections, AsmSectionBuffer& current, Int32 kind)
+	{
+		if (records.empty())
+		{
+			// code emitted before the first record belongs to it.
+			if (current.Size() == 0)
+				current = AsmSectionBuffer(kind);
+
+			return;
+		}
+
+		records.back().fSize = current.Size();
+
+		sections.push_back(std::move(current));
+		current = AsmSectionBuffer(kind);
+	}
+
+	/// @brief Close the last section, once the source is assembled.
+	inline void asm_close_sections(std::vector<LibCompiler::AERecordHeader>& records,
+								   std::vector<AsmSectionBuffer>& sections, AsmSectionBuffer& current)
+	{
+		if (!records.empty())
+			records.back().fSize = current.Size();
+
+		sections.push_back(std::move(current));
+		current = AsmSectionBuffer();
+	}
+
+	/// @brief Size of the code blob of an object, bss sections take no room in it.
+	inline std::size_t asm_file_size(const std::vector<AsmSectionBuffer>& sections) noexcept
+	{
+		std::size_t size = 0UL;
+
+		for (auto& section : sections)
+			size += section.FileSize();
+
+		return size;
+	}
+
+	/// @brief Relocations of an object, written as its relocation section after the code.
+	class AsmRelocationTable final
+	{
+	public:
+		AsmRelocationTable()  = default;
+		~AsmRelocationTable() = default;
+
+		AsmRelocationTable& operator=(const AsmRelocationTable&) = default;
+		AsmRelocationTable(const AsmRelocationTable&)			 = default;
+
+	public:
+		/// @brief Relocate the bytes at offset in the code against symbol.
+		void Add(std::size_t offset, UInt32 type, const std::string& symbol, Int64 addend = 0)
+		{
+			auto [it, inserted] = fIndex.emplace(symbol, static_cast<UInt32>(fIndex.size()));
+
+			if (inserted)
+			{
+				fStrings += symbol;
+				fStrings += '\0';
+			}
+
+			fRelocs.push_back({.fOffset = offset, .fType = type, .fSymbol = it->second, .fAddend = addend});
+		}
+
+		void Clear()
+		{
+			fRelocs.clear();
+			fIndex.clear();
+			fStrings.clear();
+		}
+
+		bool Empty() const noexcept
+		{
+			return fRelocs.empty();
+		}
+
+		/// @brief Size of the relocation section.
+		std::size_t Size() const noexcept
+		{
+			return sizeof(LibCompiler::AERelocationHeader) + fRelocs.size() * sizeof(LibCompiler::AERelocation) +
+				   fStrings.size();
+		}
+
+		/// @brief The record of the relocation section.
+		/// @param offset where the section is in the object.
+		LibCompiler::AERecordHeader Record(std::size_t offset) const noexcept
+		{
+			LibCompiler::AERecordHeader record{};
+
+			record.fKind   = LibCompiler::kAERelocationSection;
+			record.fSize   = this->Size();
+			record.fOffset = offset;
+
+			return record;
+		}
+
+		const std::vector<LibCompiler::AERelocation>& Relocations() const noexcept
+		{
+			return fRelocs;
+		}
+
+		const std::string& Strings() const noexcept
+		{
+			return fStrings;
+		}
+
+	private:
+		std::vector<LibCompiler::AERelocation>	fRelocs;
+		std::unordered_map<std::string, UInt32> fIndex;
+		std::string								fStrings;
+	};
+
+	/// @brief Records of an object in the kAEVersion layout, their names go to the string table.
+	class AsmRecordTable final
+	{
+	public:
+		AsmRecordTable()  = default;
+		~AsmRecordTable() = default;
+
+		AsmRecordTable& operator=(const AsmRecordTable&) = default;
+		AsmRecordTable(const AsmRecordTable&)			 = default;
+
+	public:
+		void Add(const LibCompiler::AERecordHeader& record)
+		{
+			this->Add(record, std::string_view(record.fName, strnlen(record.fName, kAESymbolLen)));
+		}
+
+		/// @brief Add a record named name, it may be longer than an inline name.
+		void Add(const LibCompiler::AERecordHeader& record, std::string_view name)
+		{
+			LibCompiler::AERecordHeaderV2 compact{};
+
+			compact.fName	= fStrings.Intern(name);
+			compact.fKind	= record.fKind;
+			compact.fSize	= record.fSize;
+			compact.fFlags	= record.fFlags;
+			compact.fOffset = record.fOffset;
+
+			fRecords.push_back(compact);
+		}
+
+		std::size_t Count() const noexcept
+		{
+			return fRecords.size();
+		}
+
+		/// @brief Size of the records and of their string table.
+		std::size_t Size() const noexcept
+		{
+			return fRecords.size() * sizeof(LibCompiler::AERecordHeaderV2) + fStrings.Size();
+		}
+
+		const std::vector<LibCompiler::AERecordHeaderV2>& Records() const noexcept
+		{
+			return fRecords;
+		}
+
+		const LibCompiler::StringTable& Strings() const noexcept
+		{
+			return fStrings;
+		}
+
+	private:
+		std::vector<LibCompiler::AERecordHeaderV2> fRecords;
+		LibCompiler::StringTable				   fStrings;
+	};
+
+	/// @brief An object image, built in memory and flushed with a single write.
+	class AsmObjectImage final
+	{
+	public:
+		AsmObjectImage()  = default;
+		~AsmObjectImage() = default;
+
+		AsmObjectImage& operator=(const AsmObjectImage&) = default;
+		AsmObjectImage(const AsmObjectImage&)			 = default;
+
+	public:
+		void Reserve(std::size_t size)
+		{
+			fBytes.reserve(size);
+		}
+
+		std::size_t Tell() const noexcept
+		{
+			return fBytes.size();
+		}
+
+		void Write(const void* data, std::size_t size)
+		{
+			auto bytes = static_cast<const char*>(data);
+			fBytes.insert(fBytes.end(), bytes, bytes + size);
+		}
+
+		AsmObjectImage& operator<<(const LibCompiler::AEHeader& hdr)
+		{
+			this->Write(&hdr, sizeof(LibCompiler::AEHeader));
+			return *this;
+		}
+
+		/// @brief Write the records, then their string table.
+		AsmObjectImage& operator<<(const AsmRecordTable& records)
+		{
+			this->Write(records.Records().data(), records.Count() * sizeof(LibCompiler::AERecordHeaderV2));
+			this->Write(records.Strings().Data().data(), records.Strings().Size());
+
+			return *this;
+		}
+
+		AsmObjectImage& operator<<(const AsmSectionBuffer& section)
+		{
+			this->Write(section.Data(), section.FileSize());
+			return *this;
+		}
+
+		/// @brief Write the relocation section, nothing if there are no relocations.
+		AsmObjectImage& operator<<(const AsmRelocationTable& relocs)
+		{
+			if (relocs.Empty())
+				return *this;
+
+			LibCompiler::AERelocationHeader hdr{};
+
+			hdr.fCount		 = relocs.Relocations().size();
+			hdr.fStringsSize = relocs.Strings().size();
+
+			this->Write(&hdr, sizeof(LibCompiler::AERelocationHeader));
+			this->Write(relocs.Relocations().data(), relocs.Relocations().size() * sizeof(LibCompiler::AERelocation));
+			this->Write(relocs.Strings().data(), relocs.Strings().size());
+
+			return *this;
+		}
+
+		/// @brief Write the image to path.
+		/// @return false if the file couldn't be written.
+		bool Flush(const std::string& path) const
+		{
+			int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+			if (fd < 0)
+				return false;
+
+			std::size_t written = 0UL;
+
+			// one write in practice, loop only in case it is cut short.
+			while (written < fBytes.size())
+			{
+				auto ret = ::write(fd, fBytes.data() + written, fBytes.size() - written);
+
+				if (ret <= 0)
+				{
+					::close(fd);
+					return false;
+				}
+
+				written += ret;
+			}
+
+			return ::close(fd) == 0;
+		}
+
+	private:
+		std::vector<char> fBytes;
+	};
+} // namespace Detail
@@ -8,6 +8,13 @@
 
 #include <LibCompiler/AssemblyInterface.h>
 #include <LibCompiler/Parser.h>
+#include <string_view>
+
+/// @brief comment symbols of the assemblers, AMD64 uses '#' for pragmas instead.
+#define kAsmCommentSyms ";#"
+
+/// @brief maximum number of operands an assembler line can have.
+#define kAsmOperandMax (8U)
 
 using namespace LibCompiler;
 
@@ -15,13 +22,157 @@ namespace Detail
 {
 	extern void print_error(std::string reason, std::string file) noexcept;
 	extern void print_warning(std::string reason, std::string file) noexcept;
+
+	/// @brief A lexed assembler line.
+	/// @note Every view points into the lexed line, it must outlive the tokens.
+	struct AsmTokens final
+	{
+		std::string_view fMnemonic;					// first word, without the pragma symbol.
+		std::string_view fOperands[kAsmOperandMax]; // comma separated operands, trimmed.
+		std::size_t		 fOperandCount{0UL};
+		std::string_view fRest;	   // everything after the mnemonic, trimmed.
+		std::string_view fComment; // starts at the comment symbol, empty if none.
+		bool			 fPragma{false};
+		bool			 fEmptyOperand{false};
+		bool			 fTooManyOperands{false};
+	};
+
+	/// @brief Lex an assembler line in a single pass.
+	/// @param line the line to lex.
+	/// @param comment_syms the symbols starting a comment.
+	/// @param pragma_sym the symbol starting a pragma, 0 if the assembler has none.
+	/// @return the line's tokens.
+	inline AsmTokens asm_lex_line(std::string_view line, std::string_view comment_syms, char pragma_sym = 0) noexcept
+	{
+		AsmTokens tokens;
+
+		auto is_blank = [](char c) {
+			return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+		};
+
+		auto push_operand = [&](std::size_t start, std::size_t end) {
+			if (start == std::string_view::npos)
+			{
+				tokens.fEmptyOperand = true;
+				return;
+			}
+
+			if (tokens.fOperandCount == kAsmOperandMax)
+			{
+				tokens.fTooManyOperands = true;
+				return;
+			}
+
+			tokens.fOperands[tokens.fOperandCount] = line.substr(start, end - start + 1);
+			++tokens.fOperandCount;
+		};
+
+		std::size_t index = 0UL;
+
+		while (index < line.size() && is_blank(line[index]))
+			++index;
+
+		if (pragma_sym != 0 && index < line.size() && line[index] == pragma_sym)
+		{
+			tokens.fPragma = true;
+			++index;
+		}
+
+		std::size_t start = index;
+
+		while (index < line.size() && !is_blank(line[index]) && line[index] != ',' &&
+			   comment_syms.find(line[index]) == std::string_view::npos)
+			++index;
+
+		tokens.fMnemonic = line.substr(start, index - start);
+
+		std::size_t rest_start = std::string_view::npos;
+		std::size_t rest_end   = std::string_view::npos;
+		std::size_t op_start   = std::string_view::npos;
+		std::size_t op_end	   = std::string_view::npos;
+		bool		has_comma  = false;
+		bool		in_string  = false;
+
+		for (; index < line.size(); ++index)
+		{
+			char ch = line[index];
+
+			if (ch == '"')
+				in_string = !in_string;
+
+			if (!in_string && comment_syms.find(ch) != std::string_view::npos)
+			{
+				tokens.fComment = line.substr(index);
+				break;
+			}
+
+			if (is_blank(ch))
+				continue;
+
+			if (rest_start == std::string_view::npos)
+				rest_start = index;
+
+			rest_end = index;
+
+			if (!in_string && ch == ',')
+			{
+				push_operand(op_start, op_end);
+
+				op_start  = std::string_view::npos;
+				has_comma = true;
+
+				continue;
+			}
+
+			if (op_start == std::string_view::npos)
+				op_start = index;
+
+			op_end = index;
+		}
+
+		if (op_start != std::string_view::npos || has_comma)
+			push_operand(op_start, op_end);
+
+		if (rest_start != std::string_view::npos)
+			tokens.fRest = line.substr(rest_start, rest_end - rest_start + 1);
+
+		return tokens;
+	}
+
+	/// @brief Check the operands of a lexed line.
+	/// @param tokens the lexed line.
+	/// @param line the line itself, for the error message.
+	/// @return an error message, empty if the operands are well formed.
+	inline std::string asm_check_operands(const AsmTokens& tokens, const std::string& line)
+	{
+		std::string err_str;
+
+		if (tokens.fTooManyOperands)
+		{
+			err_str += "\nInstruction has too many operands, here -> ";
+			err_str += line;
+		}
+		else if (tokens.fEmptyOperand && tokens.fRest.ends_with(','))
+		{
+			err_str += "\nInstruction lacks right register, here -> ";
+			err_str += tokens.fRest.substr(tokens.fRest.rfind(','));
+		}
+		else if (tokens.fEmptyOperand)
+		{
+			err_str += "\nInstruction not complete, here -> ";
+			err_str += line;
+		}
+
+		return err_str;
+	}
 } // namespace Detail
 
 /// @brief Get Number from lineBuffer.
 /// @param lineBuffer the lineBuffer to fetch from.
 /// @param numberKey where to seek that number.
 /// @return
-static NumberCast32 GetNumber32(std::string lineBuffer, std::string numberKey)
+/// @note inline, not every assembler calls it, static, it reads the kVerbose of the one including it.
+static inline NumberCast32 GetNumber32(std::string lineBuffer, std::string numberKey)
 {
 	auto pos = lineBuffer.find(numberKey) + numberKey.size();
 
@@ -29,62 +29,1125 @@
 
 //! Advanced Executable Object Format.
 #include <LibCompiler/AE.h>
+
+//! Static libraries.
+#include <LibCompiler/AR.h>
 #include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <fcntl.h>
+#include <span>
+#include <string_view>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+
+#define kLinkerVersionStr "\e[0;97m NeKernel 64-Bit Linker (Preferred Executable) %s, (c) Amlal El Mahrouss 2024-2025, all rights reserved.\n"
+
+#define MemoryCopy(DST, SRC, SZ) memcpy(DST, SRC, SZ)
+#define StringCompare(DST, SRC)	 strcmp(DST, SRC)
+
+#define kPefNoCpu	 (0U)
+#define kPefNoSubCpu (0U)
+
+#define kStdOut (std::cout << "\e[0;31m" \
+						   << "ld64: "   \
+						   << "\e[0;97m")
+
+#define kLinkerDefaultOrigin kPefBaseOrigin
+#define kLinkerId			 (0x5046FF)
+#define kLinkerAbiContainer	 "Container:ABI:"
+#define kLinkerSegmentContainer "Container:Segment:"
+
+#define kPrintF			printf
+#define kLinkerSplash() kPrintF(kLinkerVersionStr, kDistVersion)
+
+/// @brief PEF stack size symbol.
+#define kLinkerStackSizeSymbol "__PEFSizeOfReserveStack"
+
+/// @brief Sidecar index of an incremental link, next to its output.
+#define kLinkerIndexExt		".ilk"
+#define kLinkerIndexMagic	"ILK!"
+#define kLinkerIndexVersion (2)
+
+namespace Detail
+{
+	struct DynamicLinkerBlob final
+	{
+		std::span<CharType>					 mBlob{};		// PEF code/bss/data blob, in the mapped object.
+		UIntPtr								 mOffset{0UL};	// the offset of the PEF container header...
+		std::span<const LibCompiler::AERelocation> mRelocs{};	// relocations of the blob.
+		std::vector<std::string_view>		 mSymbols{};	// symbols the relocations refer to, by index.
+	};
+
+	/// @brief A command header of the output, its name points into a mapped object or a linker string.
+	struct DynamicLinkerCommand final
+	{
+		std::string_view Name{};
+		UInt32			 Cpu{kPefNoCpu};
+		UInt32			 SubCpu{kPefNoSubCpu};
+		UInt32			 Flags{0U};
+		UInt16			 Kind{0U};
+		UIntPtr			 Offset{0UL};
+		SizeType		 Size{0UL};
+		SizeType		 Position{0UL}; // where its bytes start in the object's code.
+	};
+
+	/// @brief What ld64 reads out of one object.
+	/// @note objects are read in parallel, then merged in command line order.
+	struct DynamicLinkerObject final
+	{
+		LibCompiler::Utils::AEMappedObject mObject{};
+		std::vector<DynamicLinkerCommand>  mCommands{};
+		DynamicLinkerBlob				   mBlob{};
+		Bool							   mHasRelocs{false};
+		Bool							   mStartFound{false};
+		Bool							   mLive{true}; // false if -gc-sections leaves it out.
+		Int32							   mError{LIBCOMPILER_SUCCESSS};
+		std::vector<LibCompiler::AERelocation> mFoldedRelocs{}; // its relocations, once -icf took records out.
+		SizeType						   mMemberOffset{0UL};	// where it is in its library, if it is a member of one.
+		SizeType						   mMemberSize{0UL};
+		LibCompiler::String				   mMemberName{};	   // its name in the library, for -map.
+		SizeType						   mFirstCommand{0UL}; // its first command header, once merged.
+		SizeType						   mSize{0UL};		   // file size, hash and time, for -incremental.
+		Int64							   mTime{0L};
+		UInt64							   mHash{0UL};
+	};
+
+	/// @brief The records of one kind, -page-align puts them together on a page.
+	struct DynamicLinkerSegment final
+	{
+		const CharType*			  mName{nullptr};
+		UInt16					  mKind{0U};
+		SizeType				  mOffset{0UL};
+		SizeType				  mSize{0UL};
+		std::vector<struct iovec> mPieces{}; // its bytes in file order, bss has none.
+	};
+
+	/// @brief A phase of the link, for -time-report.
+	struct DynamicLinkerPhase final
+	{
+		const CharType*						mName{nullptr};
+		std::chrono::steady_clock::duration mTime{};
+		SizeType							mBytes{0UL}; // what it went through.
+	};
+
+	/// @brief Header of the sidecar index of an incremental link.
+	/// The entries, then the offsets of their relocation symbols, then the string table follow it.
+	typedef struct DynamicLinkerIndexHeader final
+	{
+		CharType fMagic[4];
+		UInt32	 fVersion;
+		UInt32	 fArch;
+		UInt32	 fFatBinary;
+		UInt32	 fExecutable;
+		UInt32	 fGarbageCollect;
+		SizeType fObjectCount;
+		SizeType fSymbolCount;
+		SizeType fStringsSize;
+		SizeType fImageSize; // the output, as it was written.
+		Int64	 fImageTime;
+	} PACKED DynamicLinkerIndexHeader;
+
+	/// @brief An object of an incremental link, and where its blob is placed in the output.
+	typedef struct DynamicLinkerIndexEntry final
+	{
+		SizeType fPath; // offset in the string table.
+		SizeType fSize;
+		Int64	 fTime;
+		UInt64	 fHash;
+		SizeType fBlobPosition; // file offset of the blob.
+		SizeType fBlobSize;
+		SizeType fBlobCapacity; // room reserved for it to grow in place.
+		SizeType fBase;			// offset its command headers are placed from.
+		SizeType fFirstCommand; // its first command header in the output.
+		SizeType fCommandCount;
+		SizeType fFirstSymbol; // its relocation symbols.
+		SizeType fSymbolCount;
+	} PACKED DynamicLinkerIndexEntry;
+
+	struct DynamicLinkerIndexObject final
+	{
+		DynamicLinkerIndexEntry			 mEntry{};
+		LibCompiler::String				 mPath{};
+		std::vector<LibCompiler::String> mSymbols{}; // the symbols its relocations refer to.
+	};
+
+	/// @brief Global symbol table of a link, an open addressing hash keyed by demangled names.
+	/// @note names point into the mapped objects, symbols are kept in the order they were seen.
+	class DynamicLinkerSymbolTable final
+	{
+	public:
+		static constexpr SizeType kNoDefinition = ~0UL;
+
+		struct Symbol final
+		{
+			std::string_view fName{};
+			SizeType		 fDefinition{kNoDefinition}; // command header defining it.
+			SizeType		 fDefinitionCount{0UL};
+			Bool			 fReferenced{false};
+		};
+
+	public:
+		DynamicLinkerSymbolTable()	= default;
+		~DynamicLinkerSymbolTable() = default;
+
+		LIBCOMPILER_COPY_DELETE(DynamicLinkerSymbolTable);
+
+	public:
+		/// @brief A command header defines name.
+		void Define(std::string_view name, SizeType command_header)
+		{
+			auto& symbol = this->Insert(name);
+
+			if (symbol.fDefinitionCount++ == 0)
+				symbol.fDefinition = command_header;
+		}
+
+		/// @brief Something refers to name, it has to be defined by the end of the link.
+		void Reference(std::string_view name)
+		{
+			this->Insert(name).fReferenced = true;
+		}
+
+		const Symbol* Find(std::string_view name) const noexcept
+		{
+			if (fSlots.empty())
+				return nullptr;
+
+			for (SizeType slot = this->Hash(name);; slot = (slot + 1) & (fSlots.size() - 1))
+			{
+				if (fSlots[slot] == kEmptySlot)
+					return nullptr;
+
+				if (fSymbols[fSlots[slot]].fName == name)
+					return &fSymbols[fSlots[slot]];
+			}
+		}
+
+		const std::vector<Symbol>& Symbols() const noexcept
+		{
+			return fSymbols;
+		}
+
+	private:
+		static constexpr UInt32 kEmptySlot = ~0U;
+
+		SizeType Hash(std::string_view name) const noexcept
+		{
+			return std::hash<std::string_view>{}(name) & (fSlots.size() - 1);
+		}
+
+		Symbol& Insert(std::string_view name)
+		{
+			// keep the load under 3/4, so that probes stay short.
+			if ((fSymbols.size() + 1) * 4 > fSlots.size() * 3)
+				this->Grow();
+
+			SizeType slot = this->Hash(name);
+
+			for (; fSlots[slot] != kEmptySlot; slot = (slot + 1) & (fSlots.size() - 1))
+			{
+				if (fSymbols[fSlots[slot]].fName == name)
+					return fSymbols[fSlots[slot]];
+			}
+
+			fSlots[slot] = fSymbols.size();
+
+			return fSymbols.emplace_back(Symbol{.fName = name});
+		}
+
+		void Grow()
+		{
+			fSlots.assign(fSlots.empty() ? 64UL : fSlots.size() * 2, kEmptySlot);
+
+			for (UInt32 index = 0; index < fSymbols.size(); ++index)
+			{
+				SizeType slot = this->Hash(fSymbols[index].fName);
+
+				while (fSlots[slot] != kEmptySlot)
+					slot = (slot + 1) & (fSlots.size() - 1);
+
+				fSlots[slot] = index;
+			}
+		}
+
+	private:
+		std::vector<Symbol> fSymbols;
+		std::vector<UInt32> fSlots;
+	};
+} // namespace Detail
+
+enum
+{
+	kABITypeStart	= 0x1010, /* Invalid ABI start of ABI list. */
+	kABITypeNE		= 0x5046, /* PF (NeKernel's PEF ABI) */
+	kABITypeInvalid = 0xFFFF,
+};
+
+/* phases of a link, in the order they run. */
+enum
+{
+	kLinkerPhaseArguments,
+	kLinkerPhaseRead,
+	kLinkerPhaseResolve,
+	kLinkerPhaseCheck,
+	kLinkerPhaseLayout,
+	kLinkerPhaseRelocate,
+	kLinkerPhaseWrite,
+	kLinkerPhaseCount,
+};
+
+static LibCompiler::String kOutput			 = "a.out";
+static Int32			   kAbi				 = kABITypeNE;
+static Int32			   kSubArch			 = kPefNoSubCpu;
+static Int32			   kArch			 = LibCompiler::kPefArchInvalid;
+static Bool				   kFatBinaryEnable	 = false;
+static Bool				   kStartFound		 = false;
+static Bool				   kDuplicateSymbols = false;
+static Bool				   kVerbose			 = false;
+static Bool				   kIncremental		 = false;
+static Bool				   kGarbageCollect	 = false;
+static Bool				   kFoldCode		 = false;
+static Bool				   kTimeReport		 = false;
+static LibCompiler::String kMapFile			 = "";
+static SizeType			   kJobs			 = 1UL;
+static SizeType			   kPageAlign		 = 0UL; // 0 if records are placed back to back.
+
+/* ld64 is to be found, mld is to be found at runtime. */
+static const CharType* kLdDefineSymbol = ":UndefinedSymbol:";
+static const CharType* kLdDynamicSym   = ":RuntimeSymbol:";
+
+/// @brief Is this the name of a reference to a symbol of another object?
+static Bool ld_is_undefined_symbol(std::string_view name) noexcept
+{
+	return name.find(kLdDefineSymbol) != std::string_view::npos &&
+		   name.find(kLdDynamicSym) == std::string_view::npos;
+}
+
+/// @brief Demangle a record name, $.code64$foo and 12:UndefinedSymbol:$.code64$foo are both foo.
+static std::string_view ld_symbol_name(std::string_view name) noexcept
+{
+	return name.substr(name.rfind('$') + 1);
+}
+
+/* object code and list, libraries are searched once every object is read. */
+static std::vector<LibCompiler::String>		  kObjectList;
+static std::vector<LibCompiler::String>		  kLibraryList;
+static std::vector<Detail::DynamicLinkerBlob> kObjectBytes;
+
+/* -time-report, every phase is timed as a lap, from the end of the previous one. */
+static Detail::DynamicLinkerPhase kPhases[kLinkerPhaseCount] = {
+	{"argument parsing"}, {"object read"}, {"symbol resolution"}, {"duplicate check"}, {"layout"}, {"relocation"}, {"write"},
+};
+
+static std::chrono::steady_clock::time_point kPhaseStart{};
+
+/// @brief End a phase of the link, the next one starts now.
+/// @param bytes what the phase went through, a phase may run more than once.
+static void ld_end_phase(SizeType phase, SizeType bytes) noexcept
+{
+	auto now = std::chrono::steady_clock::now();
+
+	kPhases[phase].mTime += now - kPhaseStart;
+	kPhases[phase].mBytes += bytes;
+
+	kPhaseStart = now;
+}
+
+/// @brief Print the wall time and the bytes of every phase, if -time-report is set.
+static void ld_time_report()
+{
+	if (!kTimeReport)
+		return;
+
+	std::chrono::steady_clock::duration total{};
+	CharType							line[128];
+
+	for (auto& phase : kPhases)
+	{
+		snprintf(line, sizeof(line), "%-18s %10.3f ms %14zu byte(s)\n", phase.mName,
+				 std::chrono::duration<double, std::milli>(phase.mTime).count(), phase.mBytes);
+		kStdOut << line;
+
+		total += phase.mTime;
+	}
+
+	snprintf(line, sizeof(line), "%-18s %10.3f ms\n", "total", std::chrono::duration<double, std::milli>(total).count());
+	kStdOut << line;
+}
+
+/// @brief Write the image in one go, one writev unless it has more than IOV_MAX pieces.
+/// @param pieces the image, in file order, with no empty piece.
+static Bool ld_write_image(const LibCompiler::String& path, std::vector<struct iovec>& pieces)
+{
+	int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+	if (fd < 0)
+		return false;
+
+	SizeType piece = 0UL;
+
+	while (piece < pieces.size())
+	{
+		auto written = ::writev(fd, pieces.data() + piece, std::min<SizeType>(pieces.size() - piece, IOV_MAX));
+
+		if (written <= 0)
+		{
+			::close(fd);
+			return false;
+		}
+
+		// skip what went through, a short write carries on from the middle of a piece.
+		for (; piece < pieces.size() && SizeType(written) >= pieces[piece].iov_len; ++piece)
+			written -= pieces[piece].iov_len;
+
+		if (piece < pieces.size())
+		{
+			pieces[piece].iov_base = static_cast<char*>(pieces[piece].iov_base) + written;
+			pieces[piece].iov_len -= written;
+		}
+	}
+
+	return ::close(fd) == 0;
+}
+
+/// @brief Size and modification time of a file, in nanoseconds.
+static Bool ld_stat(const LibCompiler::String& path, SizeType& size, Int64& time) noexcept
+{
+	struct stat st;
+
+	if (::stat(path.c_str(), &st) != 0)
+		return false;
+
+	size = st.st_size;
+
+#ifdef __APPLE__
+	time = Int64(st.st_mtimespec.tv_sec) * 1000000000L + st.st_mtimespec.tv_nsec;
+#else
+	time = Int64(st.st_mtim.tv_sec) * 1000000000L + st.st_mtim.tv_nsec;
+#endif
+
+	return true;
+}
+
+/// @brief FNV-1a hash of an object, tells whether it changed since the last incremental link.
+static UInt64 ld_hash(std::span<const char> bytes) noexcept
+{
+	UInt64 hash = 0xcbf29ce484222325UL;
+
+	for (auto byte : bytes)
+	{
+		hash ^= UInt8(byte);
+		hash *= 0x100000001b3UL;
+	}
+
+	return hash;
+}
+
+/// @brief Room given to an object in an incremental link, a quarter more so that it can grow in place.
+static SizeType ld_blob_capacity(SizeType size) noexcept
+{
+	return (size + size / 4 + 64UL + 15UL) & ~SizeType(15UL);
+}
+
+/// @brief Patch the relocations of a blob, addresses are those of its symbols.
+/// @return the relocation that can't be applied, if any.
+static const LibCompiler::AERelocation* ld_relocate(Detail::DynamicLinkerBlob& blob, const std::vector<UIntPtr>& addresses) noexcept
+{
+	for (auto& reloc : blob.mRelocs)
+	{
+		if (reloc.fType != LibCompiler::kAERelocationAbs64 ||
+			reloc.fOffset + sizeof(UInt64) > blob.mBlob.size() ||
+			reloc.fSymbol >= addresses.size())
+			return &reloc;
+
+		UInt64 address = addresses[reloc.fSymbol] + reloc.fAddend;
+		MemoryCopy(blob.mBlob.data() + reloc.fOffset, &address, sizeof(UInt64));
+	}
+
+	return nullptr;
+}
+
+/// @brief Read the sidecar index of an incremental link.
+static Bool ld_read_index(const LibCompiler::String& path, Detail::DynamicLinkerIndexHeader& header, std::vector<Detail::DynamicLinkerIndexObject>& objects)
+{
+	std::ifstream input(path, std::ifstream::binary);
+
+	if (!input.read(reinterpret_cast<char*>(&header), sizeof(Detail::DynamicLinkerIndexHeader)) ||
+		memcmp(header.fMagic, kLinkerIndexMagic, sizeof(header.fMagic)) != 0 ||
+		header.fVersion != kLinkerIndexVersion)
+		return false;
+
+	std::vector<Detail::DynamicLinkerIndexEntry> entries(header.fObjectCount);
+	std::vector<SizeType>						 symbols(header.fSymbolCount);
+	LibCompiler::String							 strings(header.fStringsSize, '\0');
+
+	if (!input.read(reinterpret_cast<char*>(entries.data()), entries.size() * sizeof(Detail::DynamicLinkerIndexEntry)) ||
+		!input.read(reinterpret_cast<char*>(symbols.data()), symbols.size() * sizeof(SizeType)) ||
+		!input.read(strings.data(), strings.size()) ||
+		strings.empty() || strings.back() != '\0')
+		return false;
+
+	objects.resize(entries.size());
+
+	for (SizeType index = 0UL; index < entries.size(); ++index)
+	{
+		auto& entry = entries[index];
+
+		if (entry.fPath >= strings.size() || entry.fFirstSymbol + entry.fSymbolCount > symbols.size())
+			return false;
+
+		objects[index].mEntry = entry;
+		objects[index].mPath  = strings.c_str() + entry.fPath;
+
+		for (SizeType symbol = entry.fFirstSymbol; symbol < entry.fFirstSymbol + entry.fSymbolCount; ++symbol)
+		{
+			if (symbols[symbol] >= strings.size())
+				return false;
+
+			objects[index].mSymbols.emplace_back(strings.c_str() + symbols[symbol]);
+		}
+	}
+
+	return true;
+}
+
+/// @brief Write the sidecar index of an incremental link, once the output is written.
+static Bool ld_write_index(const LibCompiler::String& path, Detail::DynamicLinkerIndexHeader header, std::vector<Detail::DynamicLinkerIndexObject>& objects)
+{
+	LibCompiler::StringTable string_table;
+	std::vector<SizeType>	 symbols;
+
+	for (auto& object : objects)
+	{
+		object.mEntry.fPath		   = string_table.Intern(object.mPath);
+		object.mEntry.fFirstSymbol = symbols.size();
+		object.mEntry.fSymbolCount = object.mSymbols.size();
+
+		for (auto& symbol : object.mSymbols)
+			symbols.push_back(string_table.Intern(symbol));
+	}
+
+	MemoryCopy(header.fMagic, kLinkerIndexMagic, sizeof(header.fMagic));
+
+	header.fVersion		= kLinkerIndexVersion;
+	header.fObjectCount = objects.size();
+	header.fSymbolCount = symbols.size();
+	header.fStringsSize = string_table.Size();
+
+	std::ofstream output(path, std::ofstream::binary | std::ofstream::trunc);
+
+	output.write(reinterpret_cast<char*>(&header), sizeof(Detail::DynamicLinkerIndexHeader));
+
+	for (auto& object : objects)
+		output.write(reinterpret_cast<char*>(&object.mEntry), sizeof(Detail::DynamicLinkerIndexEntry));
+
+	output.write(reinterpret_cast<char*>(symbols.data()), symbols.size() * sizeof(SizeType));
+	output.write(string_table.Data().data(), string_table.Size());
+
+	return output.good();
+}
+
+/// @brief Map an object and read its records, it may run on any job.
+/// @note it doesn't print nor touch the link's state, the merge does.
+static void ld_read_object(const LibCompiler::String& path, Detail::DynamicLinkerObject& object)
+{
+	object.mObject = LibCompiler::Utils::AEMappedObject(path, object.mMemberOffset, object.mMemberSize);
+
+	if (!object.mObject.IsValid())
+		return;
+
+	if (kIncremental)
+	{
+		ld_stat(path, object.mSize, object.mTime);
+		object.mHash = ld_hash(object.mObject.Bytes());
+	}
+
+	auto& ae_header = object.mObject.Header();
+
+	LibCompiler::Utils::AEMappedRecord reloc_record{};
+
+	object.mCommands.reserve(ae_header.fCount);
+
+	SizeType code_position = 0UL;
+
+	for (size_t ae_record_index = 0; ae_record_index < ae_header.fCount;
+		 ++ae_record_index)
+	{
+		auto ae_record = object.mObject.Record(ae_record_index);
+
+		// the relocation section is read along the code.
+		if (ae_record.fKind == LibCompiler::kAERelocationSection)
+		{
+			reloc_record	  = ae_record;
+			object.mHasRelocs = true;
+
+			continue;
+		}
+
+		Detail::DynamicLinkerCommand command_header{};
+		std::size_t					 offset_of_obj = ae_record.fOffset;
+
+		// code and data sections are written in record order, bss takes no room.
+		command_header.Position = code_position;
+
+		if (ae_record.fKind == LibCompiler::kPefCode || ae_record.fKind == LibCompiler::kPefData)
+			code_position += ae_record.fSize;
+
+		command_header.Name = ae_record.fName;
+
+		std::string_view cmd_hdr_name = command_header.Name;
+
+		// check this header if it's any valid.
+		if (cmd_hdr_name.find(kPefCode64) ==
+				LibCompiler::String::npos &&
+			cmd_hdr_name.find(kPefData64) ==
+				LibCompiler::String::npos &&
+			cmd_hdr_name.find(kPefZero64) ==
+				LibCompiler::String::npos)
+		{
+			if (cmd_hdr_name.find(kPefStart) ==
+					LibCompiler::String::npos &&
+				command_header.Name.empty())
+			{
+				if (cmd_hdr_name.find(kLdDefineSymbol) !=
+					LibCompiler::String::npos)
+				{
+					goto ld_mark_header;
+				}
+				else
+				{
+					continue;
+				}
+			}
+		}
+
+		if (cmd_hdr_name.find(kPefStart) !=
+				LibCompiler::String::npos &&
+			cmd_hdr_name.find(kPefCode64) !=
+				LibCompiler::String::npos)
+		{
+			object.mStartFound = true;
+		}
+
+	ld_mark_header:
+		command_header.Offset = offset_of_obj;
+		command_header.Kind	  = ae_record.fKind;
+		command_header.Size	  = ae_record.fSize;
+		command_header.Cpu	  = ae_header.fArch;
+		command_header.SubCpu = ae_header.fSubArch;
+
+		object.mCommands.emplace_back(command_header);
+	}
+
+	// TODO: Port this to NeFS.
+
+	object.mBlob = Detail::DynamicLinkerBlob{.mBlob = object.mObject.Code(), .mOffset = ae_header.fStartCode};
+
+	if (object.mHasRelocs &&
+		!object.mObject.Relocations(reloc_record, object.mBlob.mRelocs, object.mBlob.mSymbols))
+		object.mError = LIBCOMPILER_INVALID_DATA;
+}
+
+/// @brief Relink the previous output in place, only the objects that changed are read again.
+/// @return false when it takes a full link: no usable index, a different layout, or anything to report.
+static Bool ld_relink(Bool is_executable)
+{
+	Detail::DynamicLinkerIndexHeader			  index_header{};
+	std::vector<Detail::DynamicLinkerIndexObject> index;
+
+	// the members a link pulls out of libraries aren't tracked.
+	if (!kLibraryList.empty())
+		return false;
+
+	if (!ld_read_index(kOutput + kLinkerIndexExt, index_header, index) ||
+		index_header.fArch != UInt32(kArch) ||
+		index_header.fFatBinary != kFatBinaryEnable ||
+		index_header.fExecutable != is_executable ||
+		index_header.fGarbageCollect != kGarbageCollect ||
+		index.size() != kObjectList.size())
+		return false;
+
+	SizeType image_size = 0UL;
+	Int64	 image_time = 0L;
+
+	// the output must be the one the index describes.
+	if (!ld_stat(kOutput, image_size, image_time) ||
+		image_size != index_header.fImageSize ||
+		image_time != index_header.fImageTime)
+		return false;
+
+	std::vector<Detail::DynamicLinkerObject> objects(kObjectList.size());
+	std::vector<SizeType>					 changed;
+	Bool									 touched = false;
+
+	for (SizeType object_index = 0UL; object_index < kObjectList.size(); ++object_index)
+	{
+		auto& entry = index[object_index].mEntry;
+
+		if (index[object_index].mPath != kObjectList[object_index])
+			return false;
+
+		SizeType size = 0UL;
+		Int64	 time = 0L;
+
+		if (!ld_stat(kObjectList[object_index], size, time))
+			return false;
+
+		if (size == entry.fSize && time == entry.fTime)
+			continue;
+
+		// touched, but maybe not changed.
+		ld_read_object(kObjectList[object_index], objects[object_index]);
+
+		if (!objects[object_index].mObject.IsValid())
+			return false;
+
+		touched		= true;
+		entry.fSize = size;
+		entry.fTime = time;
+
+		if (objects[object_index].mHash != entry.fHash)
+			changed.push_back(object_index);
+	}
+
+	if (changed.empty())
+	{
+		if (kVerbose)
+			kStdOut << "incremental: " << kOutput << " is up to date.\n";
+
+		return !touched || ld_write_index(kOutput + kLinkerIndexExt, index_header, index);
+	}
+
+	int fd = ::open(kOutput.c_str(), O_RDWR);
+
+	if (fd < 0)
+		return false;
+
+	// the command table as it was written.
+	LibCompiler::PEFContainer					 pef_container{};
+	std::vector<LibCompiler::PEFCommandHeaderV4> compact_headers;
+	SizeType									 strings_size = 0UL;
+	LibCompiler::String							 strings;
+
+	auto read_at = [fd](void* data, SizeType size, SizeType position) {
+		return ::pread(fd, data, size, position) == ssize_t(size);
+	};
+
+	if (!read_at(&pef_container, sizeof(LibCompiler::PEFContainer), 0UL) ||
+		pef_container.Version != kPefVersion ||
+		pef_container.Count > image_size / sizeof(LibCompiler::PEFCommandHeaderV4))
+	{
+		::close(fd);
+		return false;
+	}
+
+	compact_headers.resize(pef_container.Count);
+
+	SizeType table_size = compact_headers.size() * sizeof(LibCompiler::PEFCommandHeaderV4);
+
+	if (!read_at(compact_headers.data(), table_size, pef_container.HdrSz) ||
+		!read_at(&strings_size, sizeof(SizeType), pef_container.HdrSz + table_size) ||
+		strings_size == 0UL || strings_size > image_size)
+	{
+		::close(fd);
+		return false;
+	}
+
+	strings.resize(strings_size);
+
+	if (!read_at(strings.data(), strings_size, pef_container.HdrSz + table_size + sizeof(SizeType)) ||
+		strings.back() != '\0')
+	{
+		::close(fd);
+		return false;
+	}
+
+	auto name_of = [&strings](const LibCompiler::PEFCommandHeaderV4& hdr) {
+		return std::string_view(hdr.Name < strings.size() ? strings.c_str() + hdr.Name : "");
+	};
+
+	// where every symbol of the image is placed.
+	std::unordered_map<std::string_view, UIntPtr> addresses;
+
+	for (auto& hdr : compact_headers)
+	{
+		if (name_of(hdr).find(kLdDynamicSym) == std::string_view::npos)
+			addresses[ld_symbol_name(name_of(hdr))] = hdr.Offset;
+	}
+
+	std::unordered_set<std::string_view> moved;
+
+	for (auto object_index : changed)
+	{
+		auto& object = objects[object_index];
+		auto& entry	 = index[object_index].mEntry;
+
+		if (object.mError != LIBCOMPILER_SUCCESSS ||
+			(object.mObject.Header().fArch != kArch && !kFatBinaryEnable) ||
+			entry.fFirstCommand + entry.fCommandCount > compact_headers.size())
+		{
+			::close(fd);
+			return false;
+		}
+
+		SizeType written		 = 0UL;
+		SizeType previous_offset = entry.fBase;
+
+		for (auto& command_hdr : object.mCommands)
+		{
+			auto symbol = ld_symbol_name(command_hdr.Name);
+
+			if (ld_is_undefined_symbol(command_hdr.Name))
+			{
+				if (!addresses.contains(symbol))
+				{
+					::close(fd);
+					return false;
+				}
+
+				continue;
+			}
+
+			auto& compact_hdr = compact_headers[entry.fFirstCommand + written];
+
+			// the same records, in the same order, or the layout changed.
+			if (written == entry.fCommandCount ||
+				name_of(compact_hdr) != command_hdr.Name ||
+				compact_hdr.Kind != command_hdr.Kind)
+			{
+				::close(fd);
+				return false;
+			}
+
+			UIntPtr offset = previous_offset;
+
+			if (command_hdr.Kind == LibCompiler::kPefCode || command_hdr.Kind == LibCompiler::kPefData)
+				previous_offset += command_hdr.Size;
+
+			if (offset != compact_hdr.Offset && command_hdr.Name.find(kLdDynamicSym) == std::string_view::npos)
+			{
+				addresses[symbol] = offset;
+				moved.insert(symbol);
+			}
+
+			if (command_hdr.Name.find(kPefStart) != std::string_view::npos &&
+				command_hdr.Name.find(kPefCode64) != std::string_view::npos)
+				pef_container.Start = offset;
+
+			compact_hdr.Offset = offset;
+			compact_hdr.Size   = command_hdr.Size;
+
+			++written;
+		}
+
+		// it has to fit in the room it was given.
+		if (written != entry.fCommandCount ||
+			previous_offset - entry.fBase > entry.fBlobCapacity ||
+			object.mBlob.mBlob.size() > entry.fBlobCapacity)
+		{
+			::close(fd);
+			return false;
+		}
+
+		entry.fBlobSize = object.mBlob.mBlob.size();
+		entry.fHash		= object.mHash;
+
+		index[object_index].mSymbols.assign(object.mBlob.mSymbols.begin(), object.mBlob.mSymbols.end());
+	}
+
+	// the objects that refer to a symbol that moved are patched as well.
+	std::vector<SizeType> patched = changed;
+	std::vector<Bool>	  is_patched(index.size(), false);
+
+	for (auto object_index : changed)
+		is_patched[object_index] = true;
+
+	for (SizeType object_index = 0UL; object_index < index.size(); ++object_index)
+	{
+		if (is_patched[object_index] || moved.empty())
+			continue;
+
+		for (auto& symbol : index[object_index].mSymbols)
+		{
+			if (!moved.contains(symbol))
+				continue;
+
+			// it may be mapped already, if it was touched.
+			if (!objects[object_index].mObject.IsValid())
+				ld_read_object(kObjectList[object_index], objects[object_index]);
+
+			if (!objects[object_index].mObject.IsValid() ||
+				objects[object_index].mError != LIBCOMPILER_SUCCESSS ||
+				objects[object_index].mBlob.mBlob.size() > index[object_index].mEntry.fBlobCapacity)
+			{
+				::close(fd);
+				return false;
+			}
+
+			patched.push_back(object_index);
+			break;
+		}
+	}
+
+	for (auto object_index : patched)
+	{
+		auto& blob = objects[object_index].mBlob;
+
+		std::vector<UIntPtr> symbol_addresses;
+
+		for (auto& symbol : blob.mSymbols)
+		{
+			auto it = addresses.find(symbol);
+
+			if (it == addresses.end())
+			{
+				::close(fd);
+				return false;
+			}
+
+			symbol_addresses.push_back(kLinkerDefaultOrigin + it->second);
+		}
+
+		if (ld_relocate(blob, symbol_addresses))
+		{
+			::close(fd);
+			return false;
+		}
+	}
+
+	// nothing is written before every check passed.
+	std::vector<char> zeroes;
+
+	for (auto object_index : patched)
+	{
+		auto& blob	= objects[object_index].mBlob;
+		auto& entry = index[object_index].mEntry;
+
+		// the rest of its room is zeroed, the image doesn't depend on what was there before.
+		zeroes.assign(entry.fBlobCapacity - blob.mBlob.size(), 0);
+
+		struct iovec pieces[] = {{blob.mBlob.data(), blob.mBlob.size()}, {zeroes.data(), zeroes.size()}};
+
+		if (::pwritev(fd, pieces, 2, entry.fBlobPosition) != ssize_t(entry.fBlobCapacity))
+		{
+			::close(fd);
+			return false;
+		}
+	}
+
+	if (::pwrite(fd, compact_headers.data(), table_size, pef_container.HdrSz) != ssize_t(table_size) ||
+		::pwrite(fd, &pef_container, sizeof(LibCompiler::PEFContainer), 0UL) != sizeof(LibCompiler::PEFContainer) ||
+		::close(fd) != 0 ||
+		!ld_stat(kOutput, image_size, image_time))
+		return false;
+
+	index_header.fImageSize = image_size;
+	index_header.fImageTime = image_time;
+
+	if (kVerbose)
+		kStdOut << "incremental: relinked " << changed.size() << " object(s), patched " << patched.size() << ".\n";
+
+	return ld_write_index(kOutput + kLinkerIndexExt, index_header, index);
+}
+
+/// @brief The flag of an architecture, slices and their maps are named after it.
+static const CharType* ld_arch_name(UInt32 arch) noexcept
+{
+	switch (arch)
+	{
+	case LibCompiler::kPefArchAMD64:
+		return "amd64";
+	case LibCompiler::kPefArch32000:
+		return "32k";
+	case LibCompiler::kPefArch64000:
+		return "64k";
+	case LibCompiler::kPefArchPowerPC:
+		return "power64";
+	case LibCompiler::kPefArchRISCV:
+		return "riscv64";
+	case LibCompiler::kPefArchARM64:
+		return "arm64";
+	default:
+		return "unknown";
+	}
+}
+
+static Int32 ld_link(Bool is_executable);
+
+/// @brief Link a FAT container, the objects are split by architecture and every slice is linked by its own process.
+/// @note slices are linked side by side into <output>.<arch>, then put one after the other, kPefFatAlign aligned.
+static Int32 ld_link_fat(Bool is_executable)
+{
+	std::vector<std::pair<UInt32, std::vector<LibCompiler::String>>> slices;
+
+	for (auto& path : kObjectList)
+	{
+		LibCompiler::Utils::AEMappedObject object(path);
+
+		if (!object.IsValid())
+		{
+			kStdOut << "Not an object container: " << path << std::endl;
+			return LIBCOMPILER_EXEC_ERROR;
+		}
+
+		auto arch  = static_cast<UInt32>(object.Header().fArch);
+		auto slice = std::find_if(slices.begin(), slices.end(), [arch](auto& slice) { return slice.first == arch; });
+
+		if (slice == slices.end())
+			slice = slices.insert(slices.end(), {arch, {}});
+
+		slice->second.push_back(path);
+	}
+
+	std::vector<pid_t> jobs;
+
+	// what is buffered would be written again by every job.
+	std::cout.flush();
+
+	for (auto& [arch, objects] : slices)
+	{
+		pid_t pid = ::fork();
+
+		if (pid < 0)
+		{
+			kStdOut << "error: can't link the " << ld_arch_name(arch) << " slice: " << strerror(errno) << "\n";
+			break;
+		}
 
-#define kLinkerVersionStr "\e[0;97m NeKernel 64-Bit Linker (Preferred Executable) %s, (c) Amlal El Mahrouss 2024-2025, all rights reserved.\n"
+		if (pid == 0)
+		{
+			kArch			 = arch;
+			kObjectList		 = objects;
+			kFatBinaryEnable = false;
+			kOutput			 = kOutput + "." + ld_arch_name(arch);
 
-#define MemoryCopy(DST, SRC, SZ) memcpy(DST, SRC, SZ)
-#define StringCompare(DST, SRC)	 strcmp(DST, SRC)
+			if (!kMapFile.empty())
+				kMapFile = kMapFile + "." + ld_arch_name(arch);
 
-#define kPefNoCpu	 (0U)
-#define kPefNoSubCpu (0U)
+			if (kVerbose)
+				kStdOut << "linking the " << ld_arch_name(arch) << " slice, " << objects.size() << " object(s).\n";
 
-#define kStdOut (std::cout << "\e[0;31m" \
-						   << "ld64: "   \
-						   << "\e[0;97m")
+			Int32 status = ld_link(is_executable);
 
-#define kLinkerDefaultOrigin kPefBaseOrigin
-#define kLinkerId			 (0x5046FF)
-#define kLinkerAbiContainer	 "Container:ABI:"
+			std::cout.flush();
+			::_exit(status);
+		}
 
-#define kPrintF			printf
-#define kLinkerSplash() kPrintF(kLinkerVersionStr, kDistVersion)
+		jobs.push_back(pid);
+	}
 
-/// @brief PEF stack size symbol.
-#define kLinkerStackSizeSymbol "__PEFSizeOfReserveStack"
+	Int32 status = jobs.size() == slices.size() ? LIBCOMPILER_SUCCESSS : LIBCOMPILER_EXEC_ERROR;
 
-namespace Detail
-{
-	struct DynamicLinkerBlob final
+	for (auto& job : jobs)
 	{
-		std::vector<CharType> mBlob{};		// PEF code/bss/data blob.
-		UIntPtr				  mOffset{0UL}; // the offset of the PEF container header...
-	};
-} // namespace Detail
+		int job_status = 0;
 
-enum
-{
-	kABITypeStart	= 0x1010, /* Invalid ABI start of ABI list. */
-	kABITypeNE		= 0x5046, /* PF (NeKernel's PEF ABI) */
-	kABITypeInvalid = 0xFFFF,
-};
+		// exit statuses are 8 bits, errors are small negative numbers.
+		if (::waitpid(job, &job_status, 0) < 0 || !WIFEXITED(job_status))
+			status = LIBCOMPILER_EXEC_ERROR;
+		else if (WEXITSTATUS(job_status) != 0 && status == LIBCOMPILER_SUCCESSS)
+			status = static_cast<Int8>(WEXITSTATUS(job_status));
+	}
 
-static LibCompiler::String kOutput			 = "a.out";
-static Int32			   kAbi				 = kABITypeNE;
-static Int32			   kSubArch			 = kPefNoSubCpu;
-static Int32			   kArch			 = LibCompiler::kPefArchInvalid;
-static Bool				   kFatBinaryEnable	 = false;
-static Bool				   kStartFound		 = false;
-static Bool				   kDuplicateSymbols = false;
-static Bool				   kVerbose			 = false;
+	LibCompiler::PEFFatContainer		  fat_container{};
+	std::vector<LibCompiler::PEFFatSlice> slice_table(slices.size());
+	std::vector<std::vector<CharType>>	  slice_bytes(slices.size());
 
-/* ld64 is to be found, mld is to be found at runtime. */
-static const CharType* kLdDefineSymbol = ":UndefinedSymbol:";
-static const CharType* kLdDynamicSym   = ":RuntimeSymbol:";
+	memcpy(fat_container.Magic, kPefMagicFat, kPefMagicLen - 1);
 
-/* object code and list. */
-static std::vector<LibCompiler::String>		  kObjectList;
-static std::vector<Detail::DynamicLinkerBlob> kObjectBytes;
+	fat_container.Version = kPefFatVersion;
+	fat_container.Kind	  = is_executable ? LibCompiler::kPefKindExec : LibCompiler::kPefKindDylib;
+	fat_container.Count	  = slices.size();
+
+	SizeType position = sizeof(LibCompiler::PEFFatContainer) + slices.size() * sizeof(LibCompiler::PEFFatSlice);
+
+	for (SizeType slice_index = 0UL; slice_index < slices.size(); ++slice_index)
+	{
+		LibCompiler::String path = kOutput + "." + ld_arch_name(slices[slice_index].first);
+
+		if (status == LIBCOMPILER_SUCCESSS)
+		{
+			std::ifstream input(path, std::ifstream::binary | std::ifstream::ate);
+
+			slice_bytes[slice_index].resize(input.tellg());
+			input.seekg(0);
+
+			if (!input.read(slice_bytes[slice_index].data(), slice_bytes[slice_index].size()))
+			{
+				kStdOut << "error: can't read " << path << "\n";
+				status = LIBCOMPILER_FILE_NOT_FOUND;
+			}
+		}
+
+		std::filesystem::remove(path);
+
+		// the slice is a PEF container of its own, it knows its sub-cpu.
+		LibCompiler::PEFContainer slice_container{};
+
+		if (status == LIBCOMPILER_SUCCESSS)
+		{
+			if (slice_bytes[slice_index].size() < sizeof(LibCompiler::PEFContainer))
+			{
+				kStdOut << "error: " << path << " isn't a PEF container.\n";
+				status = LIBCOMPILER_INVALID_DATA;
+			}
+			else
+			{
+				memcpy(&slice_container, slice_bytes[slice_index].data(), sizeof(LibCompiler::PEFContainer));
+			}
+		}
+
+		position = (position + kPefFatAlign - 1) & ~SizeType(kPefFatAlign - 1);
+
+		slice_table[slice_index].Cpu	= slices[slice_index].first;
+		slice_table[slice_index].SubCpu = slice_container.SubCpu;
+		slice_table[slice_index].Offset = position;
+		slice_table[slice_index].Size	= slice_bytes[slice_index].size();
+
+		position += slice_bytes[slice_index].size();
+	}
+
+	if (status != LIBCOMPILER_SUCCESSS)
+		return status;
+
+	static CharType kPadding[kPefFatAlign] = {0};
+
+	std::vector<struct iovec> image;
+
+	image.push_back({&fat_container, sizeof(LibCompiler::PEFFatContainer)});
+	image.push_back({slice_table.data(), slice_table.size() * sizeof(LibCompiler::PEFFatSlice)});
+
+	position = sizeof(LibCompiler::PEFFatContainer) + slice_table.size() * sizeof(LibCompiler::PEFFatSlice);
+
+	for (SizeType slice_index = 0UL; slice_index < slices.size(); ++slice_index)
+	{
+		if (slice_table[slice_index].Offset > position)
+			image.push_back({kPadding, slice_table[slice_index].Offset - position});
+
+		if (!slice_bytes[slice_index].empty())
+			image.push_back({slice_bytes[slice_index].data(), slice_bytes[slice_index].size()});
+
+		position = slice_table[slice_index].Offset + slice_table[slice_index].Size;
+	}
+
+	if (!ld_write_image(kOutput, image))
+	{
+		kStdOut << "error: can't write " << kOutput << ": " << strerror(errno) << "\n";
+		return LIBCOMPILER_FILE_NOT_FOUND;
+	}
+
+	if (kVerbose)
+		kStdOut << "wrote contents of: " << kOutput << ", " << slices.size() << " slice(s).\n";
+
+	return LIBCOMPILER_SUCCESSS;
+}
 
 static uintptr_t kMIBCount	= 8;
 static uintptr_t kByteCount = 1024;
@@ -95,10 +1158,15 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 {
 	bool is_executable = true;
 
+	kPhaseStart = std::chrono::steady_clock::now();
+
+	// argc is an int, the arguments are counted with a size_t.
+	const SizeType argument_count = static_cast<SizeType>(argc);
+
 	/**
 	 * @brief parse flags and trigger options.
 	 */
-	for (size_t linker_arg = 1; linker_arg < argc; ++linker_arg)
+	for (size_t linker_arg = 1; linker_arg < argument_count; ++linker_arg)
 	{
 		if (StringCompare(argv[linker_arg], "-help") == 0)
 		{
@@ -108,7 +1176,7 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 			kStdOut << "-help: Show linker help.\n";
 			kStdOut << "-ld-verbose: Enable linker trace.\n";
 			kStdOut << "-dylib: Output as a Dyanmic PEF.\n";
-			kStdOut << "-fat: Output as a FAT PEF.\n";
+			kStdOut << "-fat-binary: Output as a FAT PEF, one slice per architecture.\n";
 			kStdOut << "-32k: Output as a 32x0 PEF.\n";
 			kStdOut << "-64k: Output as a 64x0 PEF.\n";
 			kStdOut << "-amd64: Output as a AMD64 PEF.\n";
@@ -116,6 +1184,13 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 			kStdOut << "-power64: Output as a POWER PEF.\n";
 			kStdOut << "-arm64: Output as a ARM64 PEF.\n";
 			kStdOut << "-output: Select the output file name.\n";
+			kStdOut << "-j: Read the objects with N jobs.\n";
+			kStdOut << "-incremental: Relink in place, only the objects that changed.\n";
+			kStdOut << "-gc-sections: Leave out the objects the entrypoint doesn't reach.\n";
+			kStdOut << "-icf: Fold identical code records into one copy.\n";
+			kStdOut << "-map: Write every placed record, and the object it comes from, to a file.\n";
+			kStdOut << "-time-report: Print the time and bytes of every phase of the link.\n";
+			kStdOut << "-page-align: Group the records by kind, every group starts on an N bytes page.\n";
 
 			return EXIT_SUCCESS;
 		}
@@ -172,6 +1247,62 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 
 			continue;
 		}
+		else if (StringCompare(argv[linker_arg], "-incremental") == 0)
+		{
+			kIncremental = true;
+
+			continue;
+		}
+		else if (StringCompare(argv[linker_arg], "-gc-sections") == 0)
+		{
+			kGarbageCollect = true;
+
+			continue;
+		}
+		else if (StringCompare(argv[linker_arg], "-icf") == 0)
+		{
+			kFoldCode = true;
+
+			continue;
+		}
+		else if (StringCompare(argv[linker_arg], "-time-report") == 0)
+		{
+			kTimeReport = true;
+
+			continue;
+		}
+		else if (StringCompare(argv[linker_arg], "-page-align") == 0)
+		{
+			if ((linker_arg + 1) >= argument_count)
+			{
+				kStdOut << "-page-align: expected a page size.\n";
+				return EXIT_FAILURE;
+			}
+
+			kPageAlign = strtoul(argv[linker_arg + 1], nullptr, 0);
+			++linker_arg;
+
+			if (kPageAlign == 0UL || (kPageAlign & (kPageAlign - 1)) != 0UL)
+			{
+				kStdOut << "-page-align: not a power of two: " << argv[linker_arg] << "\n";
+				return EXIT_FAILURE;
+			}
+
+			continue;
+		}
+		else if (StringCompare(argv[linker_arg], "-map") == 0)
+		{
+			if ((linker_arg + 1) >= argument_count)
+			{
+				kStdOut << "-map: expected a file name.\n";
+				return EXIT_FAILURE;
+			}
+
+			kMapFile = argv[linker_arg + 1];
+			++linker_arg;
+
+			continue;
+		}
 		else if (StringCompare(argv[linker_arg], "-dylib") == 0)
 		{
 			if (kOutput.empty())
@@ -188,9 +1319,28 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 
 			continue;
 		}
+		else if (StringCompare(argv[linker_arg], "-j") == 0)
+		{
+			if ((linker_arg + 1) >= argument_count)
+			{
+				kStdOut << "-j: expected a job count.\n";
+				return EXIT_FAILURE;
+			}
+
+			kJobs = strtoul(argv[linker_arg + 1], nullptr, 10);
+			++linker_arg;
+
+			if (kJobs == 0UL)
+			{
+				kStdOut << "-j: invalid job count: " << argv[linker_arg] << "\n";
+				return EXIT_FAILURE;
+			}
+
+			continue;
+		}
 		else if (StringCompare(argv[linker_arg], "-output") == 0)
 		{
-			if ((linker_arg + 1) > argc)
+			if ((linker_arg + 1) > argument_count)
 				continue;
 
 			kOutput = argv[linker_arg + 1];
@@ -206,7 +1356,12 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 				return EXIT_FAILURE;
 			}
 
-			kObjectList.emplace_back(argv[linker_arg]);
+			LibCompiler::String input = argv[linker_arg];
+
+			if (input.ends_with(kPefLibExt))
+				kLibraryList.emplace_back(input);
+			else
+				kObjectList.emplace_back(input);
 
 			continue;
 		}
@@ -227,6 +1382,15 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 		namespace FS = std::filesystem;
 
 		// check for existing files, if they don't throw an error.
+		for (auto& obj : kLibraryList)
+		{
+			if (!FS::exists(obj))
+			{
+				kStdOut << "no such file: " << obj << std::endl;
+				return LIBCOMPILER_EXEC_ERROR;
+			}
+		}
+
 		for (auto& obj : kObjectList)
 		{
 			if (!FS::exists(obj))
@@ -239,6 +1403,44 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 		}
 	}
 
+	// an incremental link patches objects where they are, folded records aren't there.
+	if (kFoldCode && kIncremental)
+	{
+		kStdOut << "-icf can't be used with -incremental." << std::endl;
+		return LIBCOMPILER_EXEC_ERROR;
+	}
+
+	// objects are split by kind, an object can't grow in place.
+	if (kPageAlign > 0UL && kIncremental)
+	{
+		kStdOut << "-page-align can't be used with -incremental." << std::endl;
+		return LIBCOMPILER_EXEC_ERROR;
+	}
+
+	// slices are put together once linked, there is nothing to patch in place.
+	if (kFatBinaryEnable && kIncremental)
+	{
+		kStdOut << "-incremental can't be used with -fat-binary." << std::endl;
+		return LIBCOMPILER_EXEC_ERROR;
+	}
+
+	SizeType argument_bytes = 0UL;
+
+	for (size_t linker_arg = 1; linker_arg < argument_count; ++linker_arg)
+		argument_bytes += strlen(argv[linker_arg]);
+
+	ld_end_phase(kLinkerPhaseArguments, argument_bytes);
+
+	// a FAT container is linked one architecture at a time.
+	if (kFatBinaryEnable)
+		return ld_link_fat(is_executable);
+
+	return ld_link(is_executable);
+}
+
+/// @brief Link the objects of kArch into kOutput, a thin PEF container.
+static Int32 ld_link(Bool is_executable)
+{
 	// PEF expects a valid target architecture when outputing a binary.
 	if (kArch == 0)
 	{
@@ -246,6 +1448,23 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 		return LIBCOMPILER_EXEC_ERROR;
 	}
 
+	// an incremental link patches the previous output when it can, a map needs the whole layout.
+	if (kIncremental && kMapFile.empty() && ld_relink(is_executable))
+	{
+		SizeType image_size = 0UL;
+		Int64	 image_time = 0L;
+
+		ld_stat(kOutput, image_size, image_time);
+
+		ld_end_phase(kLinkerPhaseWrite, image_size);
+		ld_time_report();
+
+		return LIBCOMPILER_SUCCESSS;
+	}
+
+	if (kIncremental && kVerbose)
+		kStdOut << "incremental: full link of " << kOutput << ".\n";
+
 	LibCompiler::PEFContainer pef_container{};
 
 	int32_t archs = kArch;
@@ -265,262 +1484,430 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 	pef_container.Start = kLinkerDefaultOrigin;
 	pef_container.HdrSz = sizeof(LibCompiler::PEFContainer);
 
-	std::ofstream output_fc(kOutput, std::ofstream::binary);
+	//! Read AE to convert as PEF.
+
+	std::vector<Detail::DynamicLinkerCommand> command_headers;
+	std::vector<SizeType>					  command_owners; // the object of every command header.
+	Detail::DynamicLinkerSymbolTable		  symbol_table;
 
-	if (output_fc.bad())
-	{
-		if (kVerbose)
+	// objects stay mapped until the output is written, their names and code are never copied.
+	std::vector<Detail::DynamicLinkerObject> objects(kObjectList.size());
+	std::atomic<SizeType>					 next_object{0UL};
+
+	auto read_objects_job = [&objects, &next_object]() {
+		for (SizeType index = next_object++; index < objects.size(); index = next_object++)
+			ld_read_object(kObjectList[index], objects[index]);
+	};
+
+	// read the objects from first on, with kJobs jobs.
+	auto read_objects = [&](SizeType first) {
+		std::vector<std::thread> jobs;
+
+		next_object = first;
+
+		for (SizeType job = 1UL; job < std::min(kJobs, objects.size() - first); ++job)
+			jobs.emplace_back(read_objects_job);
+
+		read_objects_job();
+
+		for (auto& job : jobs)
+			job.join();
+
+		SizeType read_bytes = 0UL;
+
+		for (SizeType index = first; index < objects.size(); ++index)
+			read_bytes += objects[index].mObject.Bytes().size();
+
+		ld_end_phase(kLinkerPhaseRead, read_bytes);
+	};
+
+	// names the symbol table went through, for -time-report.
+	SizeType resolved_bytes = 0UL;
+
+	// merge an object, in command line order, so that the output doesn't depend on -j.
+	auto merge_object = [&](SizeType object_index) -> Int32 {
+		auto& objectFile = kObjectList[object_index];
+		auto& object	 = objects[object_index];
+
+		if (object.mObject.IsValid())
 		{
-			kStdOut << "error: " << strerror(errno) << "\n";
+			auto& ae_header = object.mObject.Header();
+
+			if (ae_header.fArch != kArch)
+			{
+				if (kVerbose)
+					kStdOut << "info: is this a FAT binary? : ";
+
+				if (!kFatBinaryEnable)
+				{
+					if (kVerbose)
+						kStdOut << "No.\n";
+
+					kStdOut << "error: object " << objectFile
+							<< " is a different kind of architecture and output isn't "
+							   "treated as a FAT binary."
+							<< std::endl;
+
+					return LIBCOMPILER_FAT_ERROR;
+				}
+				else
+				{
+					if (kVerbose)
+					{
+						kStdOut << "Architecture matches what we expect.\n";
+					}
+				}
+			}
+
+			// append arch type to archs varaible.
+			archs |= ae_header.fArch;
+
+			if (kVerbose)
+				kStdOut << "object header found, record count: " << ae_header.fCount << "\n";
+
+			if (object.mError != LIBCOMPILER_SUCCESSS)
+			{
+				kStdOut << "error: object " << objectFile << " has a malformed relocation section.\n";
+				return object.mError;
+			}
+
+			kStartFound |= object.mStartFound;
+
+			object.mFirstCommand = command_headers.size();
+
+			for (auto& command_header : object.mCommands)
+			{
+				if (kVerbose)
+				{
+					kStdOut << "Record: "
+							<< command_header.Name << " is marked.\n";
+
+					kStdOut << "Record offset: " << command_header.Offset << "\n";
+				}
+
+				command_headers.emplace_back(command_header);
+				command_owners.push_back(object_index);
+
+				resolved_bytes += command_header.Name.size();
+
+				// the symbol table is built while the objects are merged.
+				if (ld_is_undefined_symbol(command_header.Name))
+					symbol_table.Reference(ld_symbol_name(command_header.Name));
+				else if (!command_header.Name.empty() &&
+						 command_header.Name.find(kLdDynamicSym) == std::string_view::npos)
+					symbol_table.Define(ld_symbol_name(command_header.Name), command_headers.size() - 1);
+			}
+
+			if (kVerbose && object.mHasRelocs)
+				kStdOut << "relocation(s) found: " << object.mBlob.mRelocs.size() << "\n";
+
+			for (auto& symbol : object.mBlob.mSymbols)
+				symbol_table.Reference(symbol);
+
+			kObjectBytes.push_back(object.mBlob);
+
+			return LIBCOMPILER_SUCCESSS;
 		}
 
-		return LIBCOMPILER_FILE_NOT_FOUND;
+		kStdOut << "Not an object container: " << objectFile << std::endl;
+		// don't continue, it is a fatal error.
+		return LIBCOMPILER_EXEC_ERROR;
+	};
+
+	read_objects(0UL);
+
+	for (SizeType object_index = 0UL; object_index < objects.size(); ++object_index)
+	{
+		if (auto status = merge_object(object_index); status != LIBCOMPILER_SUCCESSS)
+			return status;
 	}
 
-	//! Read AE to convert as PEF.
+	ld_end_phase(kLinkerPhaseResolve, std::exchange(resolved_bytes, 0UL));
+
+	// step 1.5: pull the members of the libraries that define a symbol still undefined, until none does.
 
-	std::vector<LibCompiler::PEFCommandHeader> command_headers;
-	LibCompiler::Utils::AEReadableProtocol	   reader_protocol{};
+	std::vector<LibCompiler::Utils::ARIndex> libraries(kLibraryList.size());
+	std::vector<std::vector<Bool>>			 pulled(kLibraryList.size());
 
-	for (const auto& objectFile : kObjectList)
+	for (SizeType library_index = 0UL; library_index < kLibraryList.size(); ++library_index)
 	{
-		if (!std::filesystem::exists(objectFile))
-			continue;
+		if (!libraries[library_index].Read(kLibraryList[library_index]))
+		{
+			kStdOut << "Not a library: " << kLibraryList[library_index] << std::endl;
+			return LIBCOMPILER_EXEC_ERROR;
+		}
 
-		LibCompiler::AEHeader hdr{};
+		pulled[library_index].assign(libraries[library_index].Members().size(), false);
+	}
 
-		reader_protocol.FP = std::ifstream(objectFile, std::ifstream::binary);
-		reader_protocol.FP >> hdr;
+	if (!libraries.empty())
+		ld_end_phase(kLinkerPhaseRead, 0UL);
 
-		auto ae_header = hdr;
+	while (!libraries.empty())
+	{
+		SizeType first = objects.size();
 
-		if (ae_header.fMagic[0] == kAEMag0 && ae_header.fMagic[1] == kAEMag1 &&
-			ae_header.fSize == sizeof(LibCompiler::AEHeader))
+		for (auto& symbol : symbol_table.Symbols())
 		{
-			if (ae_header.fArch != kArch)
+			if (!symbol.fReferenced || symbol.fDefinitionCount > 0)
+				continue;
+
+			// the first library defining it, in command line order.
+			for (SizeType library_index = 0UL; library_index < libraries.size(); ++library_index)
 			{
-				if (kVerbose)
-					kStdOut << "info: is this a FAT binary? : ";
+				// a FAT link runs once per architecture, members built for another one are left out.
+				auto member_index = libraries[library_index].Find(symbol.fName, UInt32(kArch));
 
-				if (!kFatBinaryEnable)
+				if (member_index == kARNoMember)
+					continue;
+
+				if (!pulled[library_index][member_index])
 				{
-					if (kVerbose)
-						kStdOut << "No.\n";
+					auto& member = libraries[library_index].Members()[member_index];
+					auto& object = objects.emplace_back();
 
-					kStdOut << "error: object " << objectFile
-							<< " is a different kind of architecture and output isn't "
-							   "treated as a FAT binary."
-							<< std::endl;
+					object.mMemberOffset = member.fOffset;
+					object.mMemberSize	 = member.fSize;
+					object.mMemberName	 = libraries[library_index].Name(member.fName);
+
+					kObjectList.push_back(kLibraryList[library_index]);
+
+					pulled[library_index][member_index] = true;
 
-					return LIBCOMPILER_FAT_ERROR;
-				}
-				else
-				{
 					if (kVerbose)
-					{
-						kStdOut << "Architecture matches what we expect.\n";
-					}
+						kStdOut << "pulled " << libraries[library_index].Name(member.fName) << " out of "
+								<< kLibraryList[library_index] << " for " << symbol.fName << ".\n";
 				}
+
+				break;
 			}
+		}
 
-			// append arch type to archs varaible.
-			archs |= ae_header.fArch;
-			std::size_t cnt = ae_header.fCount;
+		ld_end_phase(kLinkerPhaseResolve, 0UL);
 
-			if (kVerbose)
-				kStdOut << "object header found, record count: " << cnt << "\n";
+		if (objects.size() == first)
+			break;
 
-			pef_container.Count = cnt;
+		read_objects(first);
 
-			char_type* raw_ae_records =
-				new char_type[cnt * sizeof(LibCompiler::AERecordHeader)];
+		for (SizeType object_index = first; object_index < objects.size(); ++object_index)
+		{
+			if (auto status = merge_object(object_index); status != LIBCOMPILER_SUCCESSS)
+				return status;
+		}
 
-			if (!raw_ae_records)
-			{
-				if (kVerbose)
-					kStdOut << "allocation failure for records of n: " << cnt << "\n";
-			}
+		ld_end_phase(kLinkerPhaseResolve, std::exchange(resolved_bytes, 0UL));
+	}
 
-			memset(raw_ae_records, 0, cnt * sizeof(LibCompiler::AERecordHeader));
+	pef_container.Cpu = archs;
 
-			auto* ae_records = reader_protocol.Read(raw_ae_records, cnt);
+	// step 2: check for errors (multiple symbols, undefined ones), every symbol is looked at once.
 
-			for (size_t ae_record_index = 0; ae_record_index < cnt;
-				 ++ae_record_index)
-			{
-				LibCompiler::PEFCommandHeader command_header{0};
-				std::size_t					  offset_of_obj = ae_records[ae_record_index].fOffset;
+	Bool	 undefined_symbols = false;
+	SizeType checked_bytes	   = 0UL;
 
-				MemoryCopy(command_header.Name, ae_records[ae_record_index].fName,
-						   kPefNameLen);
+	for (auto& symbol : symbol_table.Symbols())
+	{
+		checked_bytes += symbol.fName.size();
 
-				LibCompiler::String cmd_hdr_name(command_header.Name);
+		if (symbol.fDefinitionCount > 1)
+		{
+			kStdOut << "Multiple symbols of: " << symbol.fName << " detected, cannot continue.\n";
+			kDuplicateSymbols = true;
+		}
+		else if (symbol.fReferenced && symbol.fDefinitionCount == 0)
+		{
+			kStdOut << "undefined symbol " << symbol.fName << "\n";
+			undefined_symbols = true;
+		}
+		else if (kVerbose && symbol.fReferenced)
+		{
+			kStdOut << "found symbol: " << command_headers[symbol.fDefinition].Name << "\n";
+		}
+	}
 
-				// check this header if it's any valid.
-				if (cmd_hdr_name.find(kPefCode64) ==
-						LibCompiler::String::npos &&
-					cmd_hdr_name.find(kPefData64) ==
-						LibCompiler::String::npos &&
-					cmd_hdr_name.find(kPefZero64) ==
-						LibCompiler::String::npos)
-				{
-					if (cmd_hdr_name.find(kPefStart) ==
-							LibCompiler::String::npos &&
-						*command_header.Name == 0)
-					{
-						if (cmd_hdr_name.find(kLdDefineSymbol) !=
-							LibCompiler::String::npos)
-						{
-							goto ld_mark_header;
-						}
-						else
-						{
-							continue;
-						}
-					}
-				}
+	if (kDuplicateSymbols || undefined_symbols)
+		return LIBCOMPILER_EXEC_ERROR;
 
-				if (cmd_hdr_name.find(kPefStart) !=
-						LibCompiler::String::npos &&
-					cmd_hdr_name.find(kPefCode64) !=
-						LibCompiler::String::npos)
-				{
-					kStartFound = true;
-				}
+	ld_end_phase(kLinkerPhaseCheck, checked_bytes);
 
-			ld_mark_header:
-				command_header.Offset = offset_of_obj;
-				command_header.Kind	  = ae_records[ae_record_index].fKind;
-				command_header.Size	  = ae_records[ae_record_index].fSize;
-				command_header.Cpu	  = ae_header.fArch;
-				command_header.SubCpu = ae_header.fSubArch;
+	// step 2.1: -gc-sections keeps the objects reachable from the entrypoint, or from the exports of a dylib.
 
-				if (kVerbose)
-				{
-					kStdOut << "Record: "
-							<< ae_records[ae_record_index].fName << " is marked.\n";
+	if (kGarbageCollect)
+	{
+		std::vector<SizeType> reachable;
 
-					kStdOut << "Record offset: " << command_header.Offset << "\n";
-				}
+		for (SizeType object_index = 0UL; object_index < objects.size(); ++object_index)
+		{
+			auto& object = objects[object_index];
 
-				command_headers.emplace_back(command_header);
-			}
+			// every public symbol of a dylib is exported.
+			object.mLive = is_executable ? object.mStartFound
+										 : std::any_of(object.mCommands.begin(), object.mCommands.end(), [](auto& command) {
+											   return !command.Name.empty() && !ld_is_undefined_symbol(command.Name) &&
+													  command.Name.find(kLdDynamicSym) == std::string_view::npos;
+										   });
 
-			delete[] raw_ae_records;
-			raw_ae_records = nullptr;
+			if (object.mLive)
+				reachable.push_back(object_index);
+		}
 
-			std::vector<char> bytes;
-			bytes.resize(ae_header.fCodeSize);
+		// nothing to start from, keep everything and let step 3 report it.
+		if (reachable.empty())
+		{
+			for (auto& object : objects)
+				object.mLive = true;
+		}
 
-			// TODO: Port this to NeFS.
+		auto reach = [&](std::string_view name) {
+			auto symbol = symbol_table.Find(name);
 
-			reader_protocol.FP.seekg(std::streamsize(ae_header.fStartCode));
-			reader_protocol.FP.read(bytes.data(), std::streamsize(ae_header.fCodeSize));
+			if (!symbol || symbol->fDefinition == Detail::DynamicLinkerSymbolTable::kNoDefinition)
+				return;
 
-			kObjectBytes.push_back({.mBlob = bytes, .mOffset = ae_header.fStartCode});
+			auto owner = command_owners[symbol->fDefinition];
 
-			// Blob was written, close fp.
+			if (!objects[owner].mLive)
+			{
+				objects[owner].mLive = true;
+				reachable.push_back(owner);
+			}
+		};
 
-			reader_protocol.FP.close();
+		// an object reaches what its undefined symbols and relocations refer to.
+		while (!reachable.empty())
+		{
+			auto& object = objects[reachable.back()];
+			reachable.pop_back();
 
-			continue;
+			for (auto& command_header : object.mCommands)
+			{
+				if (ld_is_undefined_symbol(command_header.Name))
+					reach(ld_symbol_name(command_header.Name));
+			}
+
+			for (auto& symbol : object.mBlob.mSymbols)
+				reach(symbol);
 		}
 
-		kStdOut << "Not an object container: " << objectFile << std::endl;
-		// don't continue, it is a fatal error.
-		return LIBCOMPILER_EXEC_ERROR;
+		for (SizeType object_index = 0UL; object_index < objects.size(); ++object_index)
+		{
+			if (kVerbose && !objects[object_index].mLive)
+				kStdOut << "gc: left out " << kObjectList[object_index] << ", "
+						<< objects[object_index].mBlob.mBlob.size() << " byte(s).\n";
+		}
 	}
 
-	pef_container.Cpu = archs;
+	// step 2.2: -icf folds the .code64 records that have the same bytes and refer to the same symbols.
 
-	output_fc << pef_container;
+	std::unordered_map<SizeType, SizeType> folded; // command header -> the one it was folded into.
 
-	if (kVerbose)
+	if (kFoldCode)
 	{
-		kStdOut << "Wrote container header.\n";
-	}
+		std::unordered_map<LibCompiler::String, SizeType> signatures;
+		SizeType										  folded_size = 0UL;
 
-	output_fc.seekp(std::streamsize(pef_container.HdrSz));
+		for (SizeType object_index = 0UL; object_index < objects.size(); ++object_index)
+		{
+			auto& object = objects[object_index];
+			auto& blob	 = kObjectBytes[object_index];
 
-	std::vector<LibCompiler::String> not_found;
-	std::vector<LibCompiler::String> symbols;
+			if (!object.mLive)
+				continue;
 
-	// step 2: check for errors (multiple symbols, undefined ones)
+			// relocations by offset, so that a record finds its own quickly.
+			std::vector<const LibCompiler::AERelocation*> relocs;
 
-	for (auto& command_hdr : command_headers)
-	{
-		// check if this symbol needs to be resolved.
-		if (LibCompiler::String(command_hdr.Name).find(kLdDefineSymbol) !=
-				LibCompiler::String::npos &&
-			LibCompiler::String(command_hdr.Name).find(kLdDynamicSym) == LibCompiler::String::npos)
-		{
-			if (kVerbose)
-				kStdOut << "Found undefined symbol: " << command_hdr.Name << "\n";
+			for (auto& reloc : blob.mRelocs)
+				relocs.push_back(&reloc);
+
+			std::sort(relocs.begin(), relocs.end(), [](auto lhs, auto rhs) { return lhs->fOffset < rhs->fOffset; });
 
-			if (auto it = std::find(not_found.begin(), not_found.end(),
-									LibCompiler::String(command_hdr.Name));
-				it == not_found.end())
+			std::vector<std::pair<SizeType, SizeType>> removed; // byte ranges taken out of the blob.
+
+			for (SizeType command_index = object.mFirstCommand;
+				 command_index < object.mFirstCommand + object.mCommands.size(); ++command_index)
 			{
-				not_found.emplace_back(command_hdr.Name);
-			}
-		}
+				auto& command_hdr = command_headers[command_index];
 
-		symbols.emplace_back(command_hdr.Name);
-	}
+				if (command_hdr.Kind != LibCompiler::kPefCode || command_hdr.Size == 0UL ||
+					command_hdr.Name.find(kPefCode64) == std::string_view::npos ||
+					command_hdr.Name.find(kPefStart) != std::string_view::npos ||
+					command_hdr.Name.find(kLdDynamicSym) != std::string_view::npos ||
+					ld_is_undefined_symbol(command_hdr.Name) ||
+					command_hdr.Position + command_hdr.Size > blob.mBlob.size())
+					continue;
 
-	// Now try to solve these symbols.
+				// its bytes, then every relocation in it by offset, type, addend and symbol.
+				LibCompiler::String signature(blob.mBlob.data() + command_hdr.Position, command_hdr.Size);
 
-	for (size_t not_found_idx = 0; not_found_idx < command_headers.size();
-		 ++not_found_idx)
-	{
-		if (const auto it = std::find(not_found.begin(), not_found.end(),
-									  LibCompiler::String(command_headers[not_found_idx].Name));
-			it != not_found.end())
-		{
-			LibCompiler::String symbol_imp = *it;
+				auto first = std::lower_bound(relocs.begin(), relocs.end(), command_hdr.Position,
+											  [](auto reloc, SizeType position) { return reloc->fOffset < position; });
 
-			if (symbol_imp.find(kLdDefineSymbol) == LibCompiler::String::npos)
-				continue;
+				for (auto it = first; it != relocs.end() && (*it)->fOffset < command_hdr.Position + command_hdr.Size; ++it)
+				{
+					UInt64 fields[] = {(*it)->fOffset - command_hdr.Position, (*it)->fType, UInt64((*it)->fAddend)};
+
+					signature.append(reinterpret_cast<const char*>(fields), sizeof(fields));
+					signature += blob.mSymbols[(*it)->fSymbol];
+					signature += '\0';
+				}
+
+				auto [it, first_seen] = signatures.emplace(std::move(signature), command_index);
+
+				if (first_seen)
+					continue;
+
+				folded[command_index] = it->second;
+				folded_size += command_hdr.Size;
+
+				removed.emplace_back(command_hdr.Position, command_hdr.Size);
 
-			// erase the lookup prefix.
-			symbol_imp.erase(
-				0, symbol_imp.find(kLdDefineSymbol) + strlen(kLdDefineSymbol));
+				if (kVerbose)
+					kStdOut << "icf: folded " << command_hdr.Name << " into " << command_headers[it->second].Name << ".\n";
+			}
+
+			if (removed.empty())
+				continue;
 
-			// demangle everything.
-			while (symbol_imp.find('$') != LibCompiler::String::npos)
-				symbol_imp.erase(symbol_imp.find('$'), 1);
+			// close the gaps, the relocations after one move along with the code.
+			SizeType kept = 0UL;
+			SizeType from = 0UL;
 
-			// the reason we do is because, this may not match the symbol, and we need
-			// to look for other matching symbols.
-			for (auto& command_hdr : command_headers)
+			for (auto& [position, size] : removed)
 			{
-				if (LibCompiler::String(command_hdr.Name).find(symbol_imp) !=
-						LibCompiler::String::npos &&
-					LibCompiler::String(command_hdr.Name).find(kLdDefineSymbol) ==
-						LibCompiler::String::npos)
-				{
-					LibCompiler::String undefined_symbol = command_hdr.Name;
-					auto				result_of_sym =
-						undefined_symbol.substr(undefined_symbol.find(symbol_imp));
+				memmove(blob.mBlob.data() + kept, blob.mBlob.data() + from, position - from);
 
-					for (int i = 0; result_of_sym[i] != 0; ++i)
-					{
-						if (result_of_sym[i] != symbol_imp[i])
-							goto ld_continue_search;
-					}
+				kept += position - from;
+				from = position + size;
+			}
 
-					not_found.erase(it);
+			memmove(blob.mBlob.data() + kept, blob.mBlob.data() + from, blob.mBlob.size() - from);
+			blob.mBlob = blob.mBlob.first(kept + blob.mBlob.size() - from);
 
-					if (kVerbose)
-						kStdOut << "found symbol: " << command_hdr.Name << "\n";
+			std::vector<SizeType> removed_before(1, 0UL);
 
-					break;
-				}
+			for (auto& [position, size] : removed)
+				removed_before.push_back(removed_before.back() + size);
+
+			for (auto& reloc : blob.mRelocs)
+			{
+				auto next = std::upper_bound(removed.begin(), removed.end(), reloc.fOffset,
+											 [](SizeType offset, auto& range) { return offset < range.first; });
+
+				// the folded record's copy is relocated where it was kept.
+				if (next != removed.begin() && reloc.fOffset < std::prev(next)->first + std::prev(next)->second)
+					continue;
+
+				object.mFoldedRelocs.push_back(reloc);
+				object.mFoldedRelocs.back().fOffset -= removed_before[next - removed.begin()];
 			}
 
-		ld_continue_search:
-			continue;
+			blob.mRelocs = object.mFoldedRelocs;
 		}
+
+		if (kVerbose)
+			kStdOut << "icf: folded " << folded.size() << " record(s), " << folded_size << " byte(s).\n";
 	}
 
 	// step 3: check for errors (recheck if we have those symbols.)
@@ -538,23 +1925,24 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 
 	// step 4: write all PEF commands.
 
-	LibCompiler::PEFCommandHeader date_cmd_hdr{};
+	SizeType linker_commands = command_headers.size();
+
+	Detail::DynamicLinkerCommand date_cmd_hdr{};
 
 	time_t timestamp = time(nullptr);
 
 	LibCompiler::String timeStampStr = "Container:BuildEpoch:";
 	timeStampStr += std::to_string(timestamp);
 
-	strncpy(date_cmd_hdr.Name, timeStampStr.c_str(), timeStampStr.size());
-
+	date_cmd_hdr.Name	= timeStampStr;
 	date_cmd_hdr.Flags	= 0;
 	date_cmd_hdr.Kind	= LibCompiler::kPefZero;
-	date_cmd_hdr.Offset = output_fc.tellp();
+	date_cmd_hdr.Offset = pef_container.HdrSz;
 	date_cmd_hdr.Size	= timeStampStr.size();
 
 	command_headers.push_back(date_cmd_hdr);
 
-	LibCompiler::PEFCommandHeader abi_cmd_hdr{};
+	Detail::DynamicLinkerCommand abi_cmd_hdr{};
 
 	LibCompiler::String abi = kLinkerAbiContainer;
 
@@ -579,27 +1967,25 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 	}
 	}
 
-	MemoryCopy(abi_cmd_hdr.Name, abi.c_str(), abi.size());
-
+	abi_cmd_hdr.Name   = abi;
 	abi_cmd_hdr.Size   = abi.size();
-	abi_cmd_hdr.Offset = output_fc.tellp();
+	abi_cmd_hdr.Offset = pef_container.HdrSz;
 	abi_cmd_hdr.Flags  = 0;
 	abi_cmd_hdr.Kind   = LibCompiler::kPefLinkerID;
 
 	command_headers.push_back(abi_cmd_hdr);
 
-	LibCompiler::PEFCommandHeader stack_cmd_hdr{0};
+	Detail::DynamicLinkerCommand stack_cmd_hdr{};
 
+	stack_cmd_hdr.Name	 = kLinkerStackSizeSymbol;
 	stack_cmd_hdr.Cpu	 = kArch;
 	stack_cmd_hdr.Flags	 = 0;
 	stack_cmd_hdr.Size	 = sizeof(uintptr_t);
 	stack_cmd_hdr.Offset = 0;
 
-	MemoryCopy(stack_cmd_hdr.Name, kLinkerStackSizeSymbol, strlen(kLinkerStackSizeSymbol));
-
 	command_headers.push_back(stack_cmd_hdr);
 
-	LibCompiler::PEFCommandHeader uuid_cmd_hdr{};
+	Detail::DynamicLinkerCommand uuid_cmd_hdr{};
 
 	std::random_device rd;
 
@@ -612,51 +1998,100 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 	uuids::uuid id		= gen();
 	auto		uuidStr = uuids::to_string(id);
 
-	MemoryCopy(uuid_cmd_hdr.Name, "Container:GUID:4:", strlen("Container:GUID:4:"));
-	MemoryCopy(uuid_cmd_hdr.Name + strlen("Container:GUID:4:"), uuidStr.c_str(),
-			   uuidStr.size());
+	LibCompiler::String uuid = "Container:GUID:4:" + uuidStr;
 
-	uuid_cmd_hdr.Size	= strlen(uuid_cmd_hdr.Name);
-	uuid_cmd_hdr.Offset = output_fc.tellp();
+	uuid_cmd_hdr.Name	= uuid;
+	uuid_cmd_hdr.Size	= uuid.size();
+	uuid_cmd_hdr.Offset = pef_container.HdrSz;
 	uuid_cmd_hdr.Flags	= LibCompiler::kPefLinkerID;
 	uuid_cmd_hdr.Kind	= LibCompiler::kPefZero;
 
 	command_headers.push_back(uuid_cmd_hdr);
 
-	// prepare a symbol vector.
-	std::vector<LibCompiler::String> undef_symbols;
-	std::vector<LibCompiler::String> dupl_symbols;
-	std::vector<LibCompiler::String> resolve_symbols;
+	// -page-align describes every group with a segment header, so that a loader maps them as they are.
+	SizeType								  segment_commands = command_headers.size();
+	std::vector<Detail::DynamicLinkerSegment> segments;
+
+	if (kPageAlign > 0UL)
+	{
+		segments.push_back({.mName = kLinkerSegmentContainer kPefCode64, .mKind = LibCompiler::kPefCode});
+		segments.push_back({.mName = kLinkerSegmentContainer kPefData64, .mKind = LibCompiler::kPefData});
+		segments.push_back({.mName = kLinkerSegmentContainer kPefZero64, .mKind = LibCompiler::kPefZero});
+
+		for (auto& segment : segments)
+		{
+			Detail::DynamicLinkerCommand segment_hdr{};
+
+			segment_hdr.Name  = segment.mName;
+			segment_hdr.Cpu	  = kArch;
+			segment_hdr.Flags = LibCompiler::kPefLinkerID;
+			segment_hdr.Kind  = segment.mKind;
 
-	constexpr Int32 cPaddingOffset = 16;
+			command_headers.push_back(segment_hdr);
+		}
+	}
 
-	size_t previous_offset = (command_headers.size() * sizeof(LibCompiler::PEFCommandHeader)) + cPaddingOffset;
+	// names go to the string table, it follows the last command header.
+	LibCompiler::StringTable string_table;
 
-	// Finally write down the command headers.
-	// And check for any duplications
-	for (size_t commandHeaderIndex = 0UL;
-		 commandHeaderIndex < command_headers.size(); ++commandHeaderIndex)
+	for (SizeType command_index = 0UL; command_index < command_headers.size(); ++command_index)
 	{
-		if (LibCompiler::String(command_headers[commandHeaderIndex].Name)
-					.find(kLdDefineSymbol) != LibCompiler::String::npos &&
-			LibCompiler::String(command_headers[commandHeaderIndex].Name)
-					.find(kLdDynamicSym) == LibCompiler::String::npos)
+		auto& command_hdr = command_headers[command_index];
+
+		if (ld_is_undefined_symbol(command_hdr.Name) ||
+			(command_index < linker_commands && !objects[command_owners[command_index]].mLive))
+			continue;
+
+		string_table.Intern(command_hdr.Name);
+		++pef_container.Count;
+	}
+
+	// the image is laid out up front, every offset is known before anything is written.
+	std::vector<LibCompiler::PEFCommandHeaderV4> compact_headers;
+	std::vector<SizeType>						 compact_sources; // the command header of every compact one, for -map.
+	compact_headers.reserve(pef_container.Count);
+
+	// the program bytes follow the container, its command headers and the string table.
+	SizeType previous_offset = sizeof(LibCompiler::PEFContainer) + pef_container.Count * sizeof(LibCompiler::PEFCommandHeaderV4) +
+							   sizeof(SizeType) + string_table.Size();
+
+	// folded records are placed once what they were folded into is.
+	std::vector<std::pair<SizeType, SizeType>> folded_headers;
+
+	// lay out one command header, in file order.
+	auto lay_out_command = [&](SizeType command_index) {
+		auto& command_hdr = command_headers[command_index];
+
+		if (ld_is_undefined_symbol(command_hdr.Name))
 		{
 			// ignore :UndefinedSymbol: headers, they do not contain code.
-			continue;
+			return;
 		}
 
-		LibCompiler::String symbol_name = command_headers[commandHeaderIndex].Name;
-
-		if (!symbol_name.empty())
+		if (folded.contains(command_index))
+		{
+			folded_headers.emplace_back(compact_headers.size(), command_index);
+		}
+		else if (command_index >= segment_commands)
+		{
+			// segment headers are placed along with their group.
+		}
+		else if (kPageAlign > 0UL)
 		{
-			undef_symbols.emplace_back(symbol_name);
+			// the offset is the one in the file, bss is placed past the end of it.
+			command_hdr.Offset = previous_offset;
+			previous_offset += command_hdr.Size;
 		}
+		else
+		{
+			command_hdr.Offset = previous_offset;
 
-		command_headers[commandHeaderIndex].Offset += previous_offset;
-		previous_offset += command_headers[commandHeaderIndex].Size;
+			// only code and data are in the object's blob, the rest takes no room in the file.
+			if (command_hdr.Kind == LibCompiler::kPefCode || command_hdr.Kind == LibCompiler::kPefData)
+				previous_offset += command_hdr.Size;
+		}
 
-		LibCompiler::String name = command_headers[commandHeaderIndex].Name;
+		LibCompiler::String name(command_hdr.Name);
 
 		/// so this is valid when we get to the entrypoint.
 		/// it is always a code64 container. And should equal to kPefStart as well.
@@ -664,79 +2099,268 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 		if (name.find(kPefStart) != LibCompiler::String::npos &&
 			name.find(kPefCode64) != LibCompiler::String::npos)
 		{
-			pef_container.Start = command_headers[commandHeaderIndex].Offset;
-			auto tellCurPos		= output_fc.tellp();
-
-			output_fc.seekp(0);
-			output_fc << pef_container;
-
-			output_fc.seekp(tellCurPos);
+			pef_container.Start = command_hdr.Offset;
 		}
 
 		if (kVerbose)
 		{
 			kStdOut << "Command header name: " << name << "\n";
-			kStdOut << "Real address of command header content: " << command_headers[commandHeaderIndex].Offset << "\n";
+			kStdOut << "Real address of command header content: " << command_hdr.Offset << "\n";
 		}
 
-		output_fc << command_headers[commandHeaderIndex];
+		LibCompiler::PEFCommandHeaderV4 compact_hdr{};
 
-		for (size_t sub_command_header_index = 0UL;
-			 sub_command_header_index < command_headers.size();
-			 ++sub_command_header_index)
+		compact_hdr.Name   = string_table.Intern(command_hdr.Name);
+		compact_hdr.Cpu	   = command_hdr.Cpu;
+		compact_hdr.SubCpu = command_hdr.SubCpu;
+		compact_hdr.Flags  = command_hdr.Flags;
+		compact_hdr.Kind   = command_hdr.Kind;
+		compact_hdr.Offset = command_hdr.Offset;
+		compact_hdr.Size   = command_hdr.Size;
+
+		compact_headers.push_back(compact_hdr);
+		compact_sources.push_back(command_index);
+	};
+
+	std::vector<Detail::DynamicLinkerIndexObject> index(kIncremental ? objects.size() : 0UL);
+
+	// where the blob of every object is in the file, when it is written in one piece.
+	std::vector<std::pair<SizeType, SizeType>> blob_ranges(objects.size());
+
+	if (kPageAlign > 0UL)
+	{
+		// the code of every object, then the data, then the bss, after the headers and the string table.
+		for (SizeType segment_index = 0UL; segment_index < segments.size(); ++segment_index)
 		{
-			if (sub_command_header_index == commandHeaderIndex)
-				continue;
+			auto& segment = segments[segment_index];
+
+			previous_offset = (previous_offset + kPageAlign - 1) & ~(kPageAlign - 1);
+			segment.mOffset = previous_offset;
 
-			if (LibCompiler::String(command_headers[sub_command_header_index].Name)
-						.find(kLdDefineSymbol) != LibCompiler::String::npos &&
-				LibCompiler::String(command_headers[sub_command_header_index].Name)
-						.find(kLdDynamicSym) == LibCompiler::String::npos)
+			for (SizeType object_index = 0UL; object_index < objects.size(); ++object_index)
 			{
-				if (kVerbose)
+				auto&	 object	  = objects[object_index];
+				auto&	 blob	  = kObjectBytes[object_index].mBlob;
+				SizeType position = 0UL; // where the bytes of a record are in the blob.
+
+				for (SizeType command_index = object.mFirstCommand;
+					 object.mLive && command_index < object.mFirstCommand + object.mCommands.size(); ++command_index)
 				{
-					kStdOut << "ignore :UndefinedSymbol: command header...\n";
-				}
+					auto& command_hdr = command_headers[command_index];
 
-				// ignore :UndefinedSymbol: headers, they do not contain code.
-				continue;
+					// the bss group takes what isn't code or data, it has no bytes in the blob.
+					UInt16 kind = command_hdr.Kind == LibCompiler::kPefCode || command_hdr.Kind == LibCompiler::kPefData
+									  ? command_hdr.Kind
+									  : UInt16(LibCompiler::kPefZero);
+
+					// code and data are in the blob, in record order, unless -icf took them out.
+					Bool has_bytes = kind != LibCompiler::kPefZero && !folded.contains(command_index);
+
+					if (kind != segment.mKind)
+					{
+						position += has_bytes ? command_hdr.Size : 0UL;
+						continue;
+					}
+
+					lay_out_command(command_index);
+
+					if (!has_bytes)
+						continue;
+
+					if (!ld_is_undefined_symbol(command_hdr.Name) && command_hdr.Size > 0UL)
+					{
+						auto& pieces = segment.mPieces;
+
+						// records next to each other in the blob are written in one piece.
+						if (!pieces.empty() &&
+							static_cast<CharType*>(pieces.back().iov_base) + pieces.back().iov_len == blob.data() + position)
+							pieces.back().iov_len += command_hdr.Size;
+						else
+							pieces.push_back({blob.data() + position, command_hdr.Size});
+					}
+
+					position += command_hdr.Size;
+				}
 			}
 
-			auto& command_hdr = command_headers[sub_command_header_index];
+			segment.mSize = previous_offset - segment.mOffset;
+
+			command_headers[segment_commands + segment_index].Offset = segment.mOffset;
+			command_headers[segment_commands + segment_index].Size	 = segment.mSize;
+		}
+	}
+
+	// Finally lay out the command headers, object by object.
+	for (SizeType object_index = 0UL; object_index < objects.size() && kPageAlign == 0UL; ++object_index)
+	{
+		auto&	 object		   = objects[object_index];
+		SizeType base		   = previous_offset;
+		SizeType first_command = compact_headers.size();
+
+		for (SizeType command_index = object.mFirstCommand;
+			 object.mLive && command_index < object.mFirstCommand + object.mCommands.size(); ++command_index)
+			lay_out_command(command_index);
+
+		blob_ranges[object_index] = {base, object.mLive ? kObjectBytes[object_index].mBlob.size() : 0UL};
+
+		if (!kIncremental)
+			continue;
+
+		// an incremental link leaves room for every object to grow in place.
+		auto& entry = index[object_index].mEntry;
+
+		entry.fSize			= object.mSize;
+		entry.fTime			= object.mTime;
+		entry.fHash			= object.mHash;
+		entry.fBlobSize		= object.mLive ? object.mBlob.mBlob.size() : 0UL;
+		entry.fBlobCapacity = object.mLive ? ld_blob_capacity(std::max<SizeType>(entry.fBlobSize, previous_offset - base)) : 0UL;
+		entry.fBase			= base;
+		entry.fFirstCommand = first_command;
+		entry.fCommandCount = compact_headers.size() - first_command;
+
+		index[object_index].mPath = kObjectList[object_index];
+
+		if (object.mLive)
+			index[object_index].mSymbols.assign(object.mBlob.mSymbols.begin(), object.mBlob.mSymbols.end());
+
+		previous_offset = base + entry.fBlobCapacity;
+	}
+
+	// then the linker's own.
+	for (SizeType command_index = linker_commands; command_index < command_headers.size(); ++command_index)
+		lay_out_command(command_index);
+
+	for (auto& [compact_index, command_index] : folded_headers)
+	{
+		command_headers[command_index].Offset = command_headers[folded[command_index]].Offset;
+		compact_headers[compact_index].Offset = command_headers[command_index].Offset;
+	}
+
+	ld_end_phase(kLinkerPhaseLayout, previous_offset);
+
+	SizeType strings_size = string_table.Size();
+
+	// step 2.4: apply relocations, every symbol of an object is resolved once, then relocations use its index.
+
+	SizeType relocated_bytes = 0UL;
 
-			if (command_hdr.Name ==
-				LibCompiler::String(command_headers[commandHeaderIndex].Name))
+	for (SizeType object_index = 0UL; object_index < kObjectBytes.size(); ++object_index)
+	{
+		auto& struct_of_blob = kObjectBytes[object_index];
+
+		if (!objects[object_index].mLive)
+			continue;
+
+		std::vector<UIntPtr> addresses;
+
+		for (auto& symbol : struct_of_blob.mSymbols)
+		{
+			// step 2 made sure every referenced symbol is defined.
+			auto  definition	 = symbol_table.Find(symbol)->fDefinition;
+			auto& definition_hdr = command_headers[definition];
+
+			// code and data have to be where the bytes of their object were written.
+			if (definition < linker_commands &&
+				(definition_hdr.Kind == LibCompiler::kPefCode || definition_hdr.Kind == LibCompiler::kPefData))
 			{
-				if (std::find(dupl_symbols.cbegin(), dupl_symbols.cend(),
-							  command_hdr.Name) == dupl_symbols.cend())
+				// a folded record is in the bytes of the one it was folded into.
+				auto [first, size] = blob_ranges[command_owners[folded.contains(definition) ? folded[definition] : definition]];
+
+				if (kPageAlign > 0UL)
 				{
-					dupl_symbols.emplace_back(command_hdr.Name);
-				}
+					auto& segment = segments[definition_hdr.Kind == LibCompiler::kPefCode ? 0 : 1];
 
-				if (kVerbose)
-					kStdOut << "found duplicate symbol: " << command_hdr.Name
-							<< "\n";
+					first = segment.mOffset;
+					size  = segment.mSize;
+				}
 
-				kDuplicateSymbols = true;
+				if (definition_hdr.Offset < first || definition_hdr.Offset + definition_hdr.Size > first + size)
+				{
+					kStdOut << "error: " << symbol << " is at offset " << definition_hdr.Offset
+							<< ", outside of the bytes of its record.\n";
+					return LIBCOMPILER_INVALID_DATA;
+				}
 			}
+
+			addresses.push_back(kLinkerDefaultOrigin + definition_hdr.Offset);
 		}
-	}
 
-	if (!dupl_symbols.empty())
-	{
-		for (auto& symbol : dupl_symbols)
+		if (auto reloc = ld_relocate(struct_of_blob, addresses))
 		{
-			kStdOut << "Multiple symbols of: " << symbol << " detected, cannot continue.\n";
+			kStdOut << "invalid relocation at offset: " << reloc->fOffset << "\n";
+			return LIBCOMPILER_INVALID_DATA;
 		}
 
-		return LIBCOMPILER_EXEC_ERROR;
+		if (kVerbose && !struct_of_blob.mRelocs.empty())
+			kStdOut << "applied " << struct_of_blob.mRelocs.size() << " relocation(s).\n";
+
+		relocated_bytes += struct_of_blob.mRelocs.size() * sizeof(LibCompiler::AERelocation);
+	}
+
+	ld_end_phase(kLinkerPhaseRelocate, relocated_bytes);
+
+	// step 2.5: write the container, its command headers and string table, then the program bytes.
+
+	std::vector<struct iovec> image;
+
+	image.push_back({&pef_container, sizeof(LibCompiler::PEFContainer)});
+	image.push_back({compact_headers.data(), compact_headers.size() * sizeof(LibCompiler::PEFCommandHeaderV4)});
+	image.push_back({&strings_size, sizeof(SizeType)});
+	image.push_back({const_cast<char*>(string_table.Data().data()), strings_size});
+
+	SizeType position = sizeof(LibCompiler::PEFContainer) + compact_headers.size() * sizeof(LibCompiler::PEFCommandHeaderV4) +
+						sizeof(SizeType) + strings_size;
+
+	// the room an incremental link leaves is zeroed.
+	std::vector<char> zeroes;
+
+	for (auto& entry : index)
+		zeroes.resize(std::max<SizeType>(zeroes.size(), entry.mEntry.fBlobCapacity - entry.mEntry.fBlobSize));
+
+	// -page-align writes every group at its offset, the bss isn't written.
+	if (kPageAlign > 0UL)
+		zeroes.resize(kPageAlign);
+
+	for (auto& segment : segments)
+	{
+		if (segment.mKind == LibCompiler::kPefZero || segment.mSize == 0UL)
+			continue;
+
+		if (segment.mOffset > position)
+			image.push_back({zeroes.data(), segment.mOffset - position});
+
+		image.insert(image.end(), segment.mPieces.begin(), segment.mPieces.end());
+		position = segment.mOffset + segment.mSize;
+	}
+
+	for (SizeType object_index = 0UL; object_index < kObjectBytes.size() && kPageAlign == 0UL; ++object_index)
+	{
+		auto& struct_of_blob = kObjectBytes[object_index];
+
+		if (!struct_of_blob.mBlob.empty() && objects[object_index].mLive)
+			image.push_back({struct_of_blob.mBlob.data(), struct_of_blob.mBlob.size()});
+
+		if (!kIncremental)
+			continue;
+
+		auto& entry = index[object_index].mEntry;
+
+		entry.fBlobPosition = position;
+		position += entry.fBlobCapacity;
+
+		if (entry.fBlobCapacity > entry.fBlobSize)
+			image.push_back({zeroes.data(), entry.fBlobCapacity - entry.fBlobSize});
 	}
 
-	// step 2.5: write program bytes.
+	SizeType image_bytes = 0UL;
+
+	for (auto& piece : image)
+		image_bytes += piece.iov_len;
 
-	for (auto& struct_of_blob : kObjectBytes)
+	if (!ld_write_image(kOutput, image))
 	{
-		output_fc.write(struct_of_blob.mBlob.data(), struct_of_blob.mBlob.size());
+		kStdOut << "error: can't write " << kOutput << ": " << strerror(errno) << "\n";
+		return LIBCOMPILER_FILE_NOT_FOUND;
 	}
 
 	if (kVerbose)
@@ -744,32 +2368,57 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 		kStdOut << "wrote contents of: " << kOutput << "\n";
 	}
 
-	// step 3: check if we have those symbols
+	// -map lists every placed record, where it is and the object it comes from.
+	if (!kMapFile.empty())
+	{
+		std::ofstream map(kMapFile, std::ofstream::trunc);
 
-	std::vector<LibCompiler::String> unreferenced_symbols;
+		map << "# " << kOutput << ", origin: 0x" << std::hex << kLinkerDefaultOrigin << std::dec << "\n";
+		map << "# address, offset, size, kind, name, source\n";
 
-	for (auto& command_hdr : command_headers)
-	{
-		if (auto it = std::find(not_found.begin(), not_found.end(),
-								LibCompiler::String(command_hdr.Name));
-			it != not_found.end())
+		for (SizeType compact_index = 0UL; compact_index < compact_headers.size(); ++compact_index)
 		{
-			unreferenced_symbols.emplace_back(command_hdr.Name);
+			auto&	 compact_hdr   = compact_headers[compact_index];
+			SizeType command_index = compact_sources[compact_index];
+
+			const CharType* kind = command_index >= linker_commands		   ? "linker"
+								   : compact_hdr.Kind == LibCompiler::kPefCode ? "code"
+								   : compact_hdr.Kind == LibCompiler::kPefData ? "data"
+																			   : "zero";
+
+			map << "0x" << std::hex << kLinkerDefaultOrigin + compact_hdr.Offset << std::dec << ", ";
+
+			// only code and data have bytes in the file, the rest has no file offset.
+			if ((command_index < linker_commands || command_index >= segment_commands) &&
+				(compact_hdr.Kind == LibCompiler::kPefCode || compact_hdr.Kind == LibCompiler::kPefData))
+				map << compact_hdr.Offset << ", ";
+			else
+				map << "-, ";
+
+			map << compact_hdr.Size << ", " << kind << ", " << command_headers[command_index].Name << ", ";
+
+			// the linker's own headers have no object.
+			if (command_index >= linker_commands)
+				map << "ld64\n";
+			else if (auto& object = objects[command_owners[command_index]]; !object.mMemberName.empty())
+				map << kObjectList[command_owners[command_index]] << "(" << object.mMemberName << ")\n";
+			else
+				map << kObjectList[command_owners[command_index]] << "\n";
 		}
-	}
 
-	if (!unreferenced_symbols.empty())
-	{
-		for (auto& unreferenced_symbol : unreferenced_symbols)
+		if (!map.good())
 		{
-			kStdOut << "undefined symbol " << unreferenced_symbol << "\n";
+			kStdOut << "error: can't write " << kMapFile << "\n";
+			return LIBCOMPILER_FILE_NOT_FOUND;
 		}
 
-		return LIBCOMPILER_EXEC_ERROR;
+		image_bytes += map.tellp();
 	}
 
-	if (!kStartFound || kDuplicateSymbols && std::filesystem::exists(kOutput) ||
-		!unreferenced_symbols.empty())
+	ld_end_phase(kLinkerPhaseWrite, image_bytes);
+	ld_time_report();
+
+	if (!kStartFound || kDuplicateSymbols && std::filesystem::exists(kOutput))
 	{
 		if (kVerbose)
 		{
@@ -780,6 +2429,26 @@ LIBCOMPILER_MODULE(DynamicLinker64PEF)
 		return LIBCOMPILER_EXEC_ERROR;
 	}
 
+	if (kIncremental && kLibraryList.empty())
+	{
+		Detail::DynamicLinkerIndexHeader index_header{};
+
+		SizeType image_size = 0UL;
+		Int64	 image_time = 0L;
+
+		Bool has_image = ld_stat(kOutput, image_size, image_time);
+
+		index_header.fArch		 = kArch;
+		index_header.fFatBinary	 = kFatBinaryEnable;
+		index_header.fExecutable	 = is_executable;
+		index_header.fGarbageCollect = kGarbageCollect;
+		index_header.fImageSize		 = image_size;
+		index_header.fImageTime		 = image_time;
+
+		if (!has_image || !ld_write_index(kOutput + kLinkerIndexExt, index_header, index))
+			kStdOut << "warning: can't write " << kOutput << kLinkerIndexExt << ", next link will be a full one.\n";
+	}
+
 	return LIBCOMPILER_SUCCESSS;
 }
 
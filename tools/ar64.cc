@@ -0,0 +1,22 @@
+/* -------------------------------------------
+
+	Copyright (C) 2024-2025 Amlal EL Mahrous, all rights reserved
+
+------------------------------------------- */
+
+#include <LibCompiler/Defines.h>
+
+/// @file ar64.cc
+/// @brief NE Archiver for AE objects.
+
+LC_IMPORT_C int Archiver64PEF(int argc, char const* argv[]);
+
+int main(int argc, char const* argv[])
+{
+	if (argc < 1)
+	{
+		return 1;
+	}
+
+	return Archiver64PEF(argc, argv);
+}
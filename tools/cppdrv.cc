@@ -9,19 +9,56 @@
 
 #include <LibCompiler/Defines.h>
 #include <LibCompiler/ErrorID.h>
+#include <LibCompiler/LinePipe.h>
 #include <LibCompiler/Version.h>
 #include <iostream>
 #include <cstring>
+#include <thread>
 #include <vector>
 
 LC_IMPORT_C int CPlusPlusPreprocessorMain(int argc, char const* argv[]);
 
+/// @brief Preprocess a source to the standard output, as bpp produces it.
+static int cppdrv_pipe(const char* source)
+{
+	LibCompiler::LinePipe pp_pipe;
+
+	int pp_code = 0;
+
+	std::thread pp_stage([&]() { pp_code = CPlusPlusPreprocessorPipe(source, &pp_pipe); });
+
+	for (std::string line; pp_pipe.Pop(line);)
+		std::cout << line << '\n';
+
+	pp_stage.join();
+
+	return pp_code;
+}
+
 int main(int argc, char const* argv[])
 {
-	if (auto code = CPlusPlusPreprocessorMain(2, argv);
-		code > 0)
+	if (argc > 2 && strcmp(argv[1], "-pipe") == 0)
+	{
+		for (auto index_arg = 2; index_arg < argc; ++index_arg)
+		{
+			if (auto code = cppdrv_pipe(argv[index_arg]);
+				code != LIBCOMPILER_SUCCESSS)
+			{
+				std::cerr << "cppdrv: preprocessor exited with code " << code << ".\n";
+
+				return LIBCOMPILER_EXEC_ERROR;
+			}
+		}
+
+		return LIBCOMPILER_SUCCESSS;
+	}
+
+	// every argument goes to bpp: --bpp:include-dir, --bpp:def, --bpp:jobs, --bpp:pch-dir,
+	// --bpp:deps, --bpp:skip-unchanged and the files to preprocess, see --bpp:?.
+	if (auto code = CPlusPlusPreprocessorMain(argc, argv);
+		code != LIBCOMPILER_SUCCESSS)
 	{
-		std::printf("cxxdrv: compiler exited with code %i.\n", code);
+		std::cerr << "cppdrv: preprocessor exited with code " << code << ".\n";
 
 		return LIBCOMPILER_EXEC_ERROR;
 	}
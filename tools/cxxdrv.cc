@@ -9,22 +9,80 @@
 
 #include <LibCompiler/Defines.h>
 #include <LibCompiler/ErrorID.h>
+#include <LibCompiler/LinePipe.h>
 #include <LibCompiler/Version.h>
+#include <filesystem>
 #include <iostream>
 #include <cstring>
+#include <thread>
 #include <vector>
 
 LC_IMPORT_C int CompilerCPlusPlusAMD64(int argc, char const* argv[]);
 LC_IMPORT_C int AssemblerMainAMD64(int argc, char const* argv[]);
 
+/// @brief Preprocess, compile and assemble a source in memory, each stage on its own thread.
+/// @param save_temps also write the .pp and .masm files, as the other mode does.
+static int cxxdrv_pipe(const std::string& source, bool save_temps)
+{
+	std::string pp	 = source + ".pp";
+	std::string masm = pp + ".masm";
+
+	LibCompiler::LinePipe pp_pipe;
+	LibCompiler::LinePipe asm_pipe;
+
+	if (save_temps && (!pp_pipe.Save(pp) || !asm_pipe.Save(masm)))
+	{
+		std::printf("cxxdrv: can't write %s.\n", masm.c_str());
+		return LIBCOMPILER_EXEC_ERROR;
+	}
+
+	int pp_code	 = 0;
+	int cxx_code = 0;
+
+	std::thread pp_stage([&]() { pp_code = CPlusPlusPreprocessorPipe(source.c_str(), &pp_pipe); });
+	std::thread cxx_stage([&]() { cxx_code = CompilerCPlusPlusAMD64Pipe(pp.c_str(), &pp_pipe, &asm_pipe); });
+
+	auto asm_code = AssemblerAMD64Pipe(masm.c_str(), &asm_pipe);
+
+	pp_stage.join();
+	cxx_stage.join();
+
+	if (pp_code != LIBCOMPILER_SUCCESSS)
+		std::printf("cxxdrv: preprocessor exited with code %i.\n", pp_code);
+	else if (cxx_code != LIBCOMPILER_SUCCESSS)
+		std::printf("cxxdrv: compiler exited with code %i.\n", cxx_code);
+	else if (asm_code != LIBCOMPILER_SUCCESSS)
+		std::printf("cxxdrv: assembler exited with code %i.\n", asm_code);
+	else
+		return LIBCOMPILER_SUCCESSS;
+
+	// the assembler saw what the failed stage let through, its object isn't kept.
+	std::error_code ec;
+	std::filesystem::remove(pp + kObjectFileExt, ec);
+
+	return LIBCOMPILER_EXEC_ERROR;
+}
+
 int main(int argc, char const* argv[])
 {
 	std::vector<std::string> args_list_cxx;
 	std::vector<std::string> args_list_asm;
+	std::vector<std::string> args_list_src;
+
+	bool pipe_mode	= false;
+	bool save_temps = false;
 
 	for (size_t index_arg = 0; index_arg < argc; ++index_arg)
 	{
-		if (strstr(argv[index_arg], ".cxx") ||
+		if (strcmp(argv[index_arg], "-pipe") == 0)
+		{
+			pipe_mode = true;
+		}
+		else if (strcmp(argv[index_arg], "-save-temps") == 0)
+		{
+			save_temps = true;
+		}
+		else if (strstr(argv[index_arg], ".cxx") ||
 			strstr(argv[index_arg], ".cpp") ||
 			strstr(argv[index_arg], ".cc") ||
 			strstr(argv[index_arg], ".c++") ||
@@ -32,6 +90,8 @@ int main(int argc, char const* argv[])
 		{
 			std::string arg = argv[index_arg];
 
+			args_list_src.push_back(arg);
+
 			arg += ".pp.masm";
 			args_list_asm.push_back(arg);
 
@@ -47,6 +107,18 @@ int main(int argc, char const* argv[])
 		}
 	}
 
+	if (pipe_mode)
+	{
+		for (auto& source : args_list_src)
+		{
+			if (auto code = cxxdrv_pipe(source, save_temps);
+				code != LIBCOMPILER_SUCCESSS)
+				return code;
+		}
+
+		return LIBCOMPILER_SUCCESSS;
+	}
+
 	for (auto& cli : args_list_cxx)
 	{
 		const char* arr_cli[] = {argv[0], cli.data()};